@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2019-2020 Andrey Baranov <armath123@gmail.com>
+ *
+ * This file is part of MDGeom (Multi-Dimensional Geometry).
+ *
+ * MDGeom is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * MDGeom is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with MDGeom;
+ * if not, see <http://www.gnu.org/licenses/>
+**/
+
+#pragma once
+#include "base.hpp"
+#include <algorithm>
+#include <vector>
+#include <array>
+#include <new>
+
+namespace GEOM {
+
+using namespace BASE;
+
+//Содержит покоординатное хранилище вершин (Structure of Arrays)
+namespace AXIS {
+
+//Allocator of aligned memory for vectorized loops:
+template <typename T, size_t A = 64> struct t_align {
+
+	typedef T value_type;
+
+	template <typename U> struct rebind { typedef t_align<U, A> other; };
+
+	template <typename U> t_align(const t_align<U, A> &) {}
+	t_align() {}
+
+	T *allocate(size_t num) {
+		return static_cast<T *>(::operator new(num * sizeof(T), std::align_val_t(A)));
+	}
+	void deallocate(T *ptr, size_t) {
+		::operator delete(ptr, std::align_val_t(A));
+	}
+
+	template <typename U> bool operator==(const t_align<U, A> &) const { return true; }
+	template <typename U> bool operator!=(const t_align<U, A> &) const { return false; }
+};
+
+template <typename T> using t_array = std::vector<T, t_align<T>>;
+
+template<typename T, unsigned N> struct t_axis {
+
+	typedef BASE::t_vector<T, N> t_vert;
+
+	explicit t_axis(const t_vert *_vert, size_t _num) {
+		for (int k = 0; k < N; ++ k) {
+			DATA[k].resize(_num);
+			T *dst = DATA[k].data();
+			for (size_t i = 0; i < _num; ++ i) dst[i] = _vert[i][k];
+		}
+	}
+
+	//Signed distances (vert - center) * normal for vertices of range [start, end),
+	//computed in precision of D, which may be higher than the one of coordinates:
+	template <typename D> void dot(const BASE::t_vector<D, N> &center, const BASE::t_vector<D, N> &normal,
+	                               D *ans, size_t start, size_t end) const {
+		std::fill(ans + start, ans + end, D(0));
+		for (int k = 0; k < N; ++ k) {
+			const T *src = DATA[k].data();
+			const D c = center[k], n = normal[k];
+			for (size_t i = start; i < end; ++ i) {
+				ans[i] += (D(src[i]) - c) * n;
+			}
+		}
+	}
+	template <typename D> void dot(const BASE::t_vector<D, N> &center, const BASE::t_vector<D, N> &normal,
+	                               D *ans) const {
+		dot(center, normal, ans, 0, size());
+	}
+
+	//Signed distances for vertices of the given index list (summed in the same order as above):
+	void dot(const t_vert &center, const t_vert &normal, const int *index, T *ans, size_t num) const {
+		std::fill(ans, ans + num, T(0));
+		for (int k = 0; k < N; ++ k) {
+			const T *src = DATA[k].data();
+			const T c = center[k], n = normal[k];
+			for (size_t i = 0; i < num; ++ i) {
+				ans[i] += (src[index[i]] - c) * n;
+			}
+		}
+	}
+
+	//Gather vertex from coordinate arrays:
+	t_vert get(size_t i) const {
+		t_vert ans;
+		for (int k = 0; k < N; ++ k) ans[k] = DATA[k][i];
+		return ans;
+	}
+
+	const T *operator[](int k) const {
+		return DATA[k].data();
+	}
+	size_t size() const {
+		return DATA[0].size();
+	}
+
+private:
+	t_axis(const t_axis &) = delete;
+
+	std::array<t_array<T>, N> DATA;
+};
+
+//...
+
+}//AXIS
+
+}//GEOM
@@ -19,11 +19,13 @@
 **/
 
 #pragma once
+#include "simd.hpp"
 #include <type_traits>
 #include <algorithm>
 #include <array>
 #include <numeric>
 #include <cmath>
+#include <cstdint>
 
 #include <iostream>
 #include <cassert>
@@ -42,14 +44,6 @@ static_assert(std::is_floating_point<T>::value);
 #define __CHECK_TEMPLATE_POINT_DIM(N)\
 static_assert(N > 0, "Dimension must not be lesser one!");
 
-#define __DEF_TRANSFORM_2(ans, lhs, rhs, op)\
-std::transform(\
-	lhs.begin(), lhs.end(), rhs.begin(), ans.begin(),\
-	[](const auto &a, const auto &b) {\
-	return a op b;\
-	}\
-);
-
 #define __DEF_TRANSFORM_1(ans, lhs, val, op)\
 std::transform(\
 	lhs.begin(), lhs.end(), ans.begin(),\
@@ -60,10 +54,25 @@ std::transform(\
 
 #define MATH_EPSILON (1.e-14)
 
+#ifndef MATH_EPSILON_FLOAT
+#define MATH_EPSILON_FLOAT (1.e-6)
+#endif
+
 #ifndef MATH_TYPE
 #define MATH_TYPE double
 #endif
 
+//Type of cell indices; it is fixed for the whole build (one type for all meshes
+//of a program), and methods keep intermediate counts in int, so meshes are limited
+//to 2^31 cells anyway. Meshes too large for the type are rejected with std::length_error:
+#ifndef MESH_INDEX
+#define MESH_INDEX int
+#endif
+
+//Tolerance of comparisons with zero for the given scalar type:
+template <typename T> constexpr T getEpsilon() { return T(MATH_EPSILON); }
+template <> constexpr float getEpsilon<float>() { return float(MATH_EPSILON_FLOAT); }
+
 //Forward declarations:
 
 template <typename T, unsigned N>
@@ -80,6 +89,13 @@ t_vector_3d;
 typedef t_vector<MATH_TYPE, 2>
 t_vector_2d;
 
+typedef t_vector<float, 4>
+t_vector_4f;
+typedef t_vector<float, 3>
+t_vector_3f;
+typedef t_vector<float, 2>
+t_vector_2f;
+
 template <unsigned N, unsigned M = N> using t_space = t_basis<MATH_TYPE, N, M>;
 
 template <unsigned N> using t_plane = t_basis<MATH_TYPE, N, N - 1>;
@@ -98,6 +114,15 @@ t_line_3d;
 typedef t_line<2>
 t_line_2d;
 
+template <unsigned N, unsigned M = N> using t_space_f = t_basis<float, N, M>;
+
+template <unsigned N> using t_plane_f = t_basis<float, N, N - 1>;
+
+typedef t_plane_f<4>
+t_plane_4f;
+typedef t_plane_f<3>
+t_plane_3f;
+
 
 //N-dimensional vector:
 template <typename T, unsigned N> struct t_vector {
@@ -112,6 +137,12 @@ template <typename T, unsigned N> struct t_vector {
 	inline t_vector(const T &val) { std::fill(dat.begin(), dat.end(), val); }
 	inline t_vector() {}
 
+	//Conversion from vector of other precision:
+	template <typename U, typename = typename std::enable_if<!std::is_same<U, T>::value>::type>
+	inline explicit t_vector(const t_vector<U, N> &other) {
+		for (int i = 0; i < N; ++ i) dat[i] = static_cast<T>(other[i]);
+	}
+
 	template <typename ... TT,
 	          typename = typename std::enable_if<(sizeof ... (TT) == 0) && (N == 1)>::type>
 	inline operator T() const {
@@ -125,7 +156,7 @@ template <typename T, unsigned N> struct t_vector {
 	}
 
 	inline t_vector ref(const t_basis<T, N, N - 1> &basis) const {
-		const auto &normal = basis.template ext<N>()[N - 1];
+		const auto normal = basis.template ext<N>()[N - 1];
 		return ref(basis.center(), normal);
 	}
 
@@ -141,10 +172,9 @@ template <typename T, unsigned N> struct t_vector {
 
 	inline t_vector rot(int i, int j, T angle) const {
 		t_vector ans(*this);
-		ans.dat[i] = cos(angle) * dat[i] -
-		sin(angle) * dat[j];
-		ans.dat[j] = sin(angle) * dat[i] +
-		cos(angle) * dat[j];
+		t_kernel::rot(ans.dat.data(), i, j,
+		std::cos(angle), std::sin(angle)
+		);
 		return ans;
 	}
 
@@ -153,17 +183,17 @@ template <typename T, unsigned N> struct t_vector {
 	}
 
 	//Vector operations:
-	inline t_vector sub(const t_vector &rhs) const { t_vector ans; __DEF_TRANSFORM_2(ans, (*this), rhs, -); return ans; }
-	inline t_vector add(const t_vector &rhs) const { t_vector ans; __DEF_TRANSFORM_2(ans, (*this), rhs, +); return ans; }
+	inline t_vector sub(const t_vector &rhs) const { t_vector ans; t_kernel::sub(ans.dat.data(), dat.data(), rhs.dat.data()); return ans; }
+	inline t_vector add(const t_vector &rhs) const { t_vector ans; t_kernel::add(ans.dat.data(), dat.data(), rhs.dat.data()); return ans; }
 
 	//Mixed operations:
 	inline t_vector div(const T &val) const { t_vector ans; __DEF_TRANSFORM_1(ans, (*this), val, /); return ans; }
-	inline t_vector mul(const T &val) const { t_vector ans; __DEF_TRANSFORM_1(ans, (*this), val, *); return ans; }
+	inline t_vector mul(const T &val) const { t_vector ans; t_kernel::mul(ans.dat.data(), dat.data(), val); return ans; }
 	inline t_vector sub(const T &val) const { t_vector ans; __DEF_TRANSFORM_1(ans, (*this), val, -); return ans; }
 	inline t_vector add(const T &val) const { t_vector ans; __DEF_TRANSFORM_1(ans, (*this), val, +); return ans; }
 	inline t_vector neg() const { t_vector ans; __DEF_TRANSFORM_1(ans, (*this), -1, *); return ans; }
 
-	inline const T dot(const t_vector &rhs) const { return std::inner_product(dat.begin(), dat.end(), rhs.dat.begin(), T(0)); }
+	inline const T dot(const t_vector &rhs) const { return t_kernel::dot(dat.data(), rhs.dat.data()); }
 	inline const T len()  const { return std::sqrt(len2()); }
 	inline const T len2() const { return dot(*this); }
 
@@ -172,9 +202,9 @@ template <typename T, unsigned N> struct t_vector {
 	inline bool operator==(const t_vector &rhs) const { return std::equal(dat.begin(), dat.end(), rhs.dat.begin()); }
 
 	//Assignment:
-	inline t_vector &operator+=(const t_vector &rhs) { *this = this->add(rhs); return *this; }
-	inline t_vector &operator-=(const t_vector &rhs) { *this = this->sub(rhs); return *this; }
-	inline t_vector &operator*=(const T &val) { *this = this->mul(val); return *this; }
+	inline t_vector &operator+=(const t_vector &rhs) { t_kernel::add(dat.data(), dat.data(), rhs.dat.data()); return *this; }
+	inline t_vector &operator-=(const t_vector &rhs) { t_kernel::sub(dat.data(), dat.data(), rhs.dat.data()); return *this; }
+	inline t_vector &operator*=(const T &val) { t_kernel::mul(dat.data(), dat.data(), val); return *this; }
 	inline t_vector &operator/=(const T &val) { *this = this->div(val); return *this; }
 
 	//Data access:
@@ -187,6 +217,8 @@ template <typename T, unsigned N> struct t_vector {
 	auto end() { return dat.end(); }
 
 private:
+	typedef SIMD::t_kernel<T, N> t_kernel;
+
 	std::array<T, N> dat;
 };
 
@@ -288,7 +320,7 @@ private:
 			for (int k = 0; k < i; ++ k) {
 				res -= (vec[k].dot(vec[i]) / L2[k]) * vec[k];
 			}
-			if (CHECK_DIV0 && (res.len2() < MATH_EPSILON)) {
+			if (CHECK_DIV0 && (res.len2() < getEpsilon<T>())) {
 				return false;
 			}
 			vec[i] = std::move(res);
@@ -368,7 +400,6 @@ std::istream &operator>>(std::istream &inp, t_vector<T, N> &vec) {
 #undef __CHECK_PARAMETER_PACK_SIZE
 #undef __CHECK_TEMPLATE_POINT_TYPE
 #undef __CHECK_TEMPLATE_POINT_DIM
-#undef __DEF_TRANSFORM_2
 #undef __DEF_TRANSFORM_1
 #undef __DEF_BINARY_2
 #undef __DEF_BINARY_0
@@ -27,6 +27,7 @@ using namespace BASE;
 
 namespace EXPR {
 
+template <typename T, unsigned N> struct t_affine;
 template <typename T, unsigned N> struct t_expr;
 
 template <typename T, unsigned N,
@@ -45,6 +46,40 @@ template <typename T, unsigned N,
 typename E = t_expr<T, N>>
 struct t_expr_mov;
 
+//Affine map (linear part with offset) folded from expression chain:
+template <typename T, unsigned N> struct t_affine {
+
+	t_affine(): _offset(0) {
+		for (int i = 0; i < N; ++ i) { _column[i] = 0; _column[i][i] = T(1); }
+	}
+
+	//Compose with affine transform given by its linear part and by itself:
+	template <typename L, typename A>
+	inline t_affine map(const L &lin, const A &aff) const {
+		t_affine ans;
+		for (int i = 0; i < N; ++ i) ans._column[i] = lin(_column[i]);
+		ans._offset = aff(_offset);
+		return ans;
+	}
+
+	inline t_vector<T, N>
+	operator()(const t_vector<T, N> &vec) const {
+	t_vector<T, N> ans = _offset;
+	for (int i = 0; i < N; ++ i)
+	for (int k = 0; k < N; ++ k) {
+		ans[k] += _column[i][k] * vec[i];
+	}
+	return ans;
+	}
+
+	const t_vector<T, N> &operator[](int i) const { return _column[i]; }
+	const t_vector<T, N> &offset() const { return _offset; }
+
+private:
+	std::array<t_vector<T, N>, N> _column;
+	t_vector<T, N> _offset;
+};
+
 #define __DEF_TRANSFORM(T, N, E) \
 template <typename ... TT>\
 auto ref(TT && ... args) const { return t_expr_ref<T, N, E> (*this, std::forward<TT>(args) ... ); }\
@@ -85,6 +120,13 @@ template <typename T, unsigned N, typename E> struct t_expr_ref {
 	return _expr(vec).ref(_center, _normal);
 	}
 
+	inline t_affine<T, N> affine() const {
+	return _expr.affine().map(
+		[this](const t_vector<T, N> &vec) { return vec.ref(t_vector<T, N>(0), _normal); },
+		[this](const t_vector<T, N> &vec) { return vec.ref(_center, _normal); }
+	);
+	}
+
 private:
 	const t_vector<T, N> _center;
 	const t_vector<T, N> _normal;
@@ -108,6 +150,13 @@ template <typename T, unsigned N, typename E> struct t_expr_rot_by_center {
 	);
 	}
 
+	inline t_affine<T, N> affine() const {
+	return _expr.affine().map(
+		[this](const t_vector<T, N> &vec) { return vec.rot(_i1, _i2, _angle); },
+		[this](const t_vector<T, N> &vec) { return vec.rot(_center, _i1, _i2, _angle); }
+	);
+	}
+
 private:
 	const t_vector<T, N> _center;
 	const unsigned _i1;
@@ -132,6 +181,14 @@ template <typename T, unsigned N, typename E> struct t_expr_rot_in_basis {
 	);
 	}
 
+	inline t_affine<T, N> affine() const {
+	const t_basis<T, N> origin = _basis.mov(- _basis.center());
+	return _expr.affine().map(
+		[&](const t_vector<T, N> &vec) { return vec.rot(origin, _i1, _i2, _angle); },
+		[&](const t_vector<T, N> &vec) { return vec.rot(_basis, _i1, _i2, _angle); }
+	);
+	}
+
 private:
 	const t_basis<T, N> _basis;
 	const unsigned _i1;
@@ -156,6 +213,13 @@ template <typename T, unsigned N, typename E> struct t_expr_rot {
 	);
 	}
 
+	inline t_affine<T, N> affine() const {
+	return _expr.affine().map(
+		[this](const t_vector<T, N> &vec) { return vec.rot(_i1, _i2, _angle); },
+		[this](const t_vector<T, N> &vec) { return vec.rot(_i1, _i2, _angle); }
+	);
+	}
+
 private:
 	const unsigned _i1;
 	const unsigned _i2;
@@ -178,6 +242,13 @@ template <typename T, unsigned N, typename E> struct t_expr_mov {
 	return _expr(vec).mov(_offset);
 	}
 
+	inline t_affine<T, N> affine() const {
+	return _expr.affine().map(
+		[](const t_vector<T, N> &vec) { return vec; },
+		[this](const t_vector<T, N> &vec) { return vec.mov(_offset); }
+	);
+	}
+
 private:
 	const t_vector<T, N> _offset;
 	const E _expr;
@@ -191,6 +262,10 @@ template <typename T, unsigned N> struct t_expr {
 	operator()(const t_vector<T, N> &vec) const {
 	return vec;
 	}
+
+	inline t_affine<T, N> affine() const {
+	return t_affine<T, N>();
+	}
 };
 
 //...
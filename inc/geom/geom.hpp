@@ -21,6 +21,7 @@
 #pragma once
 #include "base.hpp"
 #include "expr.hpp"
+#include "axis.hpp"
 #include "tree.hpp"
 #include "mesh.hpp"
 #include "test.hpp"
@@ -21,9 +21,18 @@
 #pragma once
 #include "base.hpp"
 #include "expr.hpp"
+#include "axis.hpp"
 #include "tree.hpp"
+#include "task.hpp"
+#include <iterator>
+#include <utility>
+#include <numeric>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <array>
+#include <limits>
 #include <vector>
 #include <map>
 
@@ -35,13 +44,218 @@ namespace MESH {
 
 template <typename T, unsigned N> using t_vert = t_vector<T, N>;
 
+//Array of items which either owns them or views read-only memory kept alive by HOLD
+//(e.g. mapped file); any modification of the viewed array makes its own copy first:
+template <typename V> struct t_store {
+
+	typedef V value_type;
+	typedef const V *const_iterator;
+	typedef V *iterator;
+
+	t_store(std::initializer_list<V> list): DATA(list) {}
+	t_store(const std::vector<V> &data): DATA(data) {}
+	t_store(std::vector<V> &&data): DATA(std::move(data)) {}
+	t_store(size_t num, const V &val = V()): DATA(num, val) {}
+	t_store(const V *view, size_t size, std::shared_ptr<const void> hold):
+	        VIEW(view), SIZE(size), HOLD(std::move(hold)) {}
+	t_store() {}
+
+	const V &operator[](size_t i) const { return data()[i]; }
+	const V *data() const { return HOLD? VIEW: DATA.data(); }
+	size_t size() const { return HOLD? SIZE: DATA.size(); }
+	size_t capacity() const { return HOLD? SIZE: DATA.capacity(); }
+	bool empty() const { return size() == 0; }
+
+	const V &front() const { return data()[0]; }
+	const V &back() const { return data()[size() - 1]; }
+
+	const V *begin() const { return data(); }
+	const V *end() const { return data() + size(); }
+
+	V &operator[](size_t i) { return edit()[i]; }
+	V *data() { return edit().data(); }
+	V *begin() { return edit().data(); }
+	V *end() { return edit().data() + DATA.size(); }
+
+	template <typename ... TT> void emplace_back(TT && ... args) { edit().emplace_back(std::forward<TT>(args) ...); }
+	void push_back(const V &item) { edit().push_back(item); }
+	void resize(size_t num) { edit().resize(num); }
+	void reserve(size_t num) { edit().reserve(num); }
+	void clear() { edit().clear(); }
+
+	//Own items (copied from the viewed memory if necessary):
+	std::vector<V> &edit() {
+		if (HOLD) {
+			DATA.assign(VIEW, VIEW + SIZE);
+			HOLD.reset();
+		}
+		return DATA;
+	}
+
+	//Copy of items for code written against std::vector (e.g. const std::vector<V> &v = mesh.vert()
+	//binds to such copy, so its address differs from data()):
+	operator std::vector<V>() const {
+		return std::vector<V>(begin(), end());
+	}
+
+	//Whether items are viewed rather than owned:
+	bool view() const {
+		return HOLD != nullptr;
+	}
+
+	template <typename C> bool operator==(const C &other) const {
+		return (size() == other.size()) && std::equal(begin(), end(), other.begin());
+	}
+	template <typename C> bool operator!=(const C &other) const {
+		return !(*this == other);
+	}
+
+private:
+	std::vector<V> DATA;
+	const V *VIEW = nullptr;
+	size_t SIZE = 0;
+	std::shared_ptr<const void> HOLD;
+};
+
+//Contiguous view of index array:
+template <typename I> struct t_span {
+
+	typedef I value_type;
+	typedef const I *const_iterator;
+	typedef const I *iterator;
+
+	t_span(const I *_data, size_t _size): DATA(_data), SIZE(_size) {}
+
+	const I &operator[](size_t i) const { return DATA[i]; }
+	const I *data() const { return DATA; }
+	size_t size() const { return SIZE; }
+	bool empty() const { return SIZE == 0; }
+
+	const I *begin() const { return DATA; }
+	const I *end() const { return DATA + SIZE; }
+
+	template <typename C> bool operator==(const C &other) const {
+		return (SIZE == other.size()) && std::equal(begin(), end(), other.begin());
+	}
+	template <typename C> bool operator!=(const C &other) const {
+		return !(*this == other);
+	}
+
+private:
+	const I *DATA;
+	size_t SIZE;
+};
+
+//List of index arrays stored as compressed rows (offsets with flat array of items):
+template <typename I> struct t_flat {
+
+	typedef t_span<I> value_type;
+
+	struct const_iterator {
+
+		typedef std::forward_iterator_tag iterator_category;
+		typedef t_span<I> value_type;
+		typedef t_span<I> reference;
+		typedef ptrdiff_t difference_type;
+		typedef void pointer;
+
+		t_span<I> operator*() const { return (*LIST)[POS]; }
+
+		const_iterator  operator++(int) { const_iterator iter(*this); ++ POS; return iter; }
+		const_iterator &operator++() { ++ POS; return *this; }
+
+		bool operator==(const const_iterator &other) const { return POS == other.POS; }
+		bool operator!=(const const_iterator &other) const { return POS != other.POS; }
+
+		const t_flat *LIST;
+		size_t POS;
+	};
+	typedef const_iterator iterator;
+
+	t_flat(const std::vector<std::vector<I>> &list): OFFS(1, 0) {
+		reserve(list.size());
+		for (const auto &item: list) push_back(item);
+	}
+	t_flat(t_store<size_t> &&offs, t_store<I> &&item):
+	       OFFS(std::move(offs)), ITEM(std::move(item)) {
+		assert(!OFFS.empty() && (OFFS.back() == ITEM.size()));
+	}
+	t_flat(): OFFS(1, 0) {}
+
+	t_span<I> operator[](size_t i) const {
+		return t_span<I>(ITEM.data() + OFFS[i], OFFS[i + 1] - OFFS[i]);
+	}
+	size_t size() const { return OFFS.size() - 1; }
+	bool empty() const { return OFFS.size() == 1; }
+
+	const_iterator begin() const { return const_iterator{this, 0}; }
+	const_iterator end() const { return const_iterator{this, size()}; }
+
+	template <typename C> void push_back(const C &item) {
+		auto &data = ITEM.edit();
+		data.insert(data.end(), item.begin(), item.end());
+		OFFS.push_back(data.size());
+	}
+	void reserve(size_t num) {
+		OFFS.reserve(num + 1);
+	}
+	void clear() {
+		OFFS.edit().assign(1, 0);
+		ITEM.clear();
+	}
+
+	//Raw arrays:
+	const t_store<size_t> &offs() const { return OFFS; }
+	const t_store<I> &item() const { return ITEM; }
+
+	bool operator==(const t_flat &other) const { return (OFFS == other.OFFS) && (ITEM == other.ITEM); }
+	bool operator!=(const t_flat &other) const { return !(*this == other); }
+
+	template <typename C> bool operator==(const std::vector<C> &other) const {
+		return (size() == other.size()) && std::equal(begin(), end(), other.begin());
+	}
+	template <typename C> bool operator!=(const std::vector<C> &other) const {
+		return !(*this == other);
+	}
+
+private:
+	t_store<size_t> OFFS;
+	t_store<I> ITEM;
+};
+
+//Type of indices kept in cells and links (e.g. uint16_t for small meshes, uint32_t to halve topology memory).
+//NOTE: It is set for the whole build by MESH_INDEX (CMake option GEOM_INDEX), so all meshes of a program
+//use the same type: one program can not keep small meshes in uint16_t and huge ones in uint32_t.
+typedef MESH_INDEX t_index;
+
+static_assert(std::is_integral<t_index>::value, "Index type must be integral!");
+
+//Largest number of items of one list: it is bounded by the index type and by int,
+//in which links and methods keep indices (e.g. nullind = -1 marks missing item):
+constexpr size_t getIndexLimit() {
+	return std::min<size_t>(std::numeric_limits<t_index>::max(), std::numeric_limits<int>::max());
+}
+
+//Throws std::length_error if items of the list of given size can not be indexed
+//(checked in all builds, since truncated indices would silently break the topology):
+inline void checkIndex(size_t num) {
+	if (num > getIndexLimit()) {
+		throw std::length_error("Too many mesh items for the index type (see MESH_INDEX)!");
+	}
+}
+
 //NOTE: Obtaining simplicial cells after such operations as slicing and etc. is very difficult for N-d case!
 //Therefore, we need to use arbitrary convex polytopes.
-template <unsigned N> struct t_item { typedef std::vector<int> t_type; };
-template <> struct t_item<1> { typedef std::array<int, 2> t_type; };
+template <unsigned N> struct t_item { typedef std::vector<t_index> t_type; typedef t_flat<t_index> t_list; };
+template <> struct t_item<1> { typedef std::array<t_index, 2> t_type; typedef t_store<t_type> t_list; };
 
 template <unsigned N> using t_cell = typename t_item<N>::t_type;
 
+//Storage of all cells of the same dimension:
+template <unsigned N> using t_list = typename t_item<N>::t_list;
+
+typedef t_flat<t_index> t_links;
+
 typedef t_cell<3> t_body;
 typedef t_cell<2> t_face;
 typedef t_cell<1> t_edge;
@@ -81,6 +295,18 @@ t_mesh<MATH_TYPE, N, 1>;
 typedef t_poly<2>
 t_poly_2d;
 
+typedef t_mesh<float, 4>
+t_mesh_4f;
+typedef t_mesh<float, 3>
+t_mesh_3f;
+typedef t_mesh<float, 2>
+t_mesh_2f;
+
+typedef t_mesh<float, 4, 3>
+t_surf_4f;
+typedef t_mesh<float, 3, 2>
+t_surf_3f;
+
 //Handler classes:
 template <unsigned N,
           unsigned M>
@@ -88,14 +314,7 @@ struct t_hand {
 
 	static_assert((M >= 0) && (M < N));
 
-	template <typename ... TT> static t_grid<N> make(const std::vector<t_cell<M>> &cell, TT && ... args) {
-		t_grid<N> grid = std::move(t_hand<N, M + 1>::
-		          make(std::forward<TT>(args) ...));
-		fill(grid, cell);
-		t_hand<N, M>::cell(grid) = cell;
-		return grid;
-	}
-	template <typename ... TT> static t_grid<N> make(std::vector<t_cell<M>> &&cell, TT && ... args) {
+	template <typename ... TT> static t_grid<N> make(t_list<M> cell, TT && ... args) {
 		t_grid<N> grid = std::move(t_hand<N, M + 1>::
 		          make(std::forward<TT>(args) ...));
 		fill(grid, cell);
@@ -118,28 +337,24 @@ struct t_hand {
 		return std::move(grid);
 	}
 
-	static void fill(t_grid<N> &grid, const std::vector<t_cell<M>> &cell) {
-		auto &link = grid.template link<M - 1>();
-		for (int c = 0; c < cell.size(); ++ c)
-		for (int l: cell[c]) {
-			if (l >= link.size()) {
-				link.resize(l + 1);
-			}
-			link[l].push_back(c);
-		}
+	static void fill(t_grid<N> &grid, const t_list<M> &cell) {
+		t_hand<N, N>::template fill<M>(grid, cell);
+	}
+	static void fill(t_grid<N> &grid, const t_list<M> &cell, TASK::t_pool &pool) {
+		t_hand<N, N>::template fill<M>(grid, cell, pool);
 	}
 
-	static const std::vector<std::vector<int>> &link(const t_grid<N> &grid) {
+	static const t_links &link(const t_grid<N> &grid) {
 		return t_hand<N-1, M>::link(grid.GRID);
 	}
-	static std::vector<std::vector<int>> &link(t_grid<N> &grid) {
+	static t_links &link(t_grid<N> &grid) {
 		return t_hand<N-1, M>::link(grid.GRID);
 	}
 
-	static const std::vector<t_cell<M>> &cell(const t_grid<N> &grid) {
+	static const t_list<M> &cell(const t_grid<N> &grid) {
 		return t_hand<N-1, M>::cell(grid.GRID);
 	}
-	static std::vector<t_cell<M>> &cell(t_grid<N> &grid) {
+	static t_list<M> &cell(t_grid<N> &grid) {
 		return t_hand<N-1, M>::cell(grid.GRID);
 	}
 
@@ -154,20 +369,16 @@ struct t_hand {
 template <unsigned N>
 struct t_hand<N, N> {
 
-	static const std::vector<std::vector<int>> &link(const t_grid<N> &grid) { return grid.LINK; }
-	static std::vector<std::vector<int>> &link(t_grid<N> &grid) { return grid.LINK; }
+	static const t_links &link(const t_grid<N> &grid) { return grid.LINK; }
+	static t_links &link(t_grid<N> &grid) { return grid.LINK; }
 
-	static const std::vector<t_cell<N>> &cell(const t_grid<N> &grid) { return grid.CELL; }
-	static std::vector<t_cell<N>> &cell(t_grid<N> &grid) { return grid.CELL; }
+	static const t_list<N> &cell(const t_grid<N> &grid) { return grid.CELL; }
+	static t_list<N> &cell(t_grid<N> &grid) { return grid.CELL; }
 
 	static const t_grid<N> &grid(const t_grid<N> &grid) { return grid; }
 	static t_grid<N> &grid(t_grid<N> &grid) { return grid; }
 
-	static t_grid<N> make(const std::vector<t_cell<N>> &cell) {
-		t_grid<N> grid; fill(grid, cell); grid.CELL = cell;
-		return grid;
-	}
-	static t_grid<N> make(std::vector<t_cell<N>> &&cell) {
+	static t_grid<N> make(t_list<N> cell) {
 		t_grid<N> grid; fill(grid, cell);
 		grid.CELL = std::move(cell);
 		return grid;
@@ -185,15 +396,98 @@ struct t_hand<N, N> {
 		return std::move(grid);
 	}
 
-	static void fill(t_grid<N> &grid, const std::vector<t_cell<N>> &cell) {
-		auto &link = grid.template link<N - 1>();
+	static void fill(t_grid<N> &grid, const t_list<N> &cell) {
+		fill<N>(grid, cell);
+	}
+	static void fill(t_grid<N> &grid, const t_list<N> &cell, TASK::t_pool &pool) {
+		fill<N>(grid, cell, pool);
+	}
+
+	//Fill links from (M-1)-cells to M-cells containing them
+	//(count pass, exclusive scan and scatter pass):
+	template <unsigned M> static void fill(t_grid<N> &grid, const t_list<M> &cell) {
+
+		//Links keep indices of cells, so they must fit into the index type:
+		checkIndex(cell.size());
+		int num = 0;
+		for (const auto &c: cell)
+		for (int l: c) {
+			num = std::max(num, l + 1);
+		}
+
+		//Links of item l are counted at (l + 2) and written from (l + 1),
+		//so after scatter pass every position holds the end of its list:
+		std::vector<size_t> offs(num + 2, 0);
+		for (const auto &c: cell)
+		for (int l: c) {
+			++ offs[l + 2];
+		}
+		std::partial_sum(offs.begin(), offs.end(), offs.begin());
+
+		std::vector<t_index> item(offs.back());
 		for (int c = 0; c < cell.size(); ++ c)
 		for (int l: cell[c]) {
-			if (l >= link.size()) {
-				link.resize(l + 1);
+			item[offs[l + 1] ++] = c;
+		}
+		offs.pop_back();
+
+		grid.template link<M - 1>() = t_links(
+			std::move(offs), std::move(item)
+		);
+	}
+
+	template <unsigned M> static void fill(t_grid<N> &grid, const t_list<M> &cell, TASK::t_pool &pool) {
+
+		checkIndex(cell.size());
+		const unsigned part_num = pool.part(cell.size());
+		if (part_num == 1) {
+			fill<M>(grid, cell);
+			return;
+		}
+
+		std::vector<int> part_max(part_num, 0);
+		pool.run(cell.size(), [&](unsigned part, size_t start, size_t end) {
+			for (size_t c = start; c < end; ++ c)
+			for (int l: cell[c]) {
+				part_max[part] = std::max(part_max[part], l + 1);
 			}
-			link[l].push_back(c);
+		});
+		const int num = *std::max_element(part_max.begin(), part_max.end());
+
+		std::unique_ptr<std::atomic<size_t>[]> count(new std::atomic<size_t>[num]);
+		for (int l = 0; l < num; ++ l) count[l].store(0, std::memory_order_relaxed);
+
+		pool.run(cell.size(), [&](unsigned, size_t start, size_t end) {
+			for (size_t c = start; c < end; ++ c)
+			for (int l: cell[c]) {
+				count[l].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		std::vector<size_t> offs(num + 1, 0);
+		for (int l = 0; l < num; ++ l) {
+			offs[l + 1] = offs[l] + count[l].load(std::memory_order_relaxed);
+			count[l].store(offs[l], std::memory_order_relaxed);
 		}
+
+		std::vector<t_index> item(offs.back());
+		pool.run(cell.size(), [&](unsigned, size_t start, size_t end) {
+			for (size_t c = start; c < end; ++ c)
+			for (int l: cell[c]) {
+				item[count[l].fetch_add(1, std::memory_order_relaxed)] = c;
+			}
+		});
+
+		//Restore order of cells within every list:
+		pool.run(num, [&](unsigned, size_t start, size_t end) {
+			for (size_t l = start; l < end; ++ l) {
+				std::sort(item.begin() + offs[l], item.begin() + offs[l + 1]);
+			}
+		});
+
+		grid.template link<M - 1>() = t_links(
+			std::move(offs), std::move(item)
+		);
 	}
 
 };
@@ -202,19 +496,19 @@ struct t_hand<N, N> {
 template <unsigned N>
 struct t_grid {
 
-	template <unsigned M> const std::vector<std::vector<int>> &link() const {
+	template <unsigned M> const t_links &link() const {
 		return t_hand<N, M>::link(*this);
 	}
-	template <unsigned M> std::vector<std::vector<int>> &link() {
+	template <unsigned M> t_links &link() {
 		return t_hand<N, M>::link(*this);
 	}
 
 	template <unsigned M, typename = typename std::enable_if<(M > 0)>::type>
-	const std::vector<t_cell<M>> &cell() const {
+	const t_list<M> &cell() const {
 		return t_hand<N, M>::cell(*this);
 	}
 	template <unsigned M, typename = typename std::enable_if<(M > 0)>::type>
-	std::vector<t_cell<M>> &cell() {
+	t_list<M> &cell() {
 		return t_hand<N, M>::cell(*this);
 	}
 
@@ -229,14 +523,14 @@ private:
 	template <unsigned _N, unsigned _M>
 	friend struct t_hand;
 
-	std::vector<std::vector<int>> LINK;
-	std::vector<t_cell<N>> CELL;
+	t_links LINK;
+	t_list<N> CELL;
 	t_grid<N-1> GRID;
 };
 
 template <> struct
 t_grid<0> {
-	std::vector<std::vector<int>> LINK;
+	t_links LINK;
 };
 
 //Iterator:
@@ -269,13 +563,13 @@ private:
 	void next() { PART.ind = *(++ ITEM); }
 	void prev() { PART.ind = *(-- ITEM); }
 
-	t_iter(const t_mesh &_mesh, const int *_item, int _ind, bool _val = true):
+	t_iter(const t_mesh &_mesh, const t_index *_item, int _ind, bool _val = true):
 	    ITEM(_item + _ind),
 	    PART(_mesh) {
 	    if (_val) PART.ind = ITEM[_ind];
 	}
 
-	const int *ITEM;
+	const t_index *ITEM;
 	t_part PART;
 };
 
@@ -294,9 +588,9 @@ template <typename T, unsigned N, unsigned M, unsigned K> struct t_link {
 		);
 	}
 
-	const std::vector<int> &item() const { return MESH.template link<K>()[ind]; }
-	int item(int i) const { return MESH.template link<K>()[ind][i]; }
-	size_t size() const { MESH.template link<K>()[ind].size(); }
+	t_span<t_index> item() const { return MESH.template link<K>()[ind]; }
+	t_index item(int i) const { return MESH.template link<K>()[ind][i]; }
+	size_t size() const { return MESH.template link<K>()[ind].size(); }
 
 private:
 	template <typename _T, unsigned _N, unsigned _M, unsigned _K>
@@ -354,8 +648,8 @@ template <typename T, unsigned N, unsigned M, unsigned K> struct t_part {
 		);
 	}
 
-	const t_cell<K> &item() const { return MESH.template cell<K>()[ind]; }
-	int item(int i) const { return MESH.template cell<K>()[ind][i]; }
+	decltype(auto) item() const { return MESH.template cell<K>()[ind]; }
+	t_index item(int i) const { return MESH.template cell<K>()[ind][i]; }
 	t_link link() const { return MESH.template link<K>(ind); }
 
 	int id() const { return ind; }
@@ -412,25 +706,27 @@ template <typename T, unsigned N, unsigned M> struct t_mesh {
 	template<unsigned K> using t_part = MESH::t_part<T, N, M, K>;
 	typedef MESH::t_vert<T, N> t_vert;
 	typedef TREE::t_tree<T, N> t_tree;
+	typedef TREE::t_bvh<T, N> t_bvh;
+	typedef AXIS::t_axis<T, N> t_axis;
 
 	static_assert(N >= M, "Mesh dimension must not be more than space dimension!");
 
-	template <typename ... TT> t_mesh(const std::vector<t_vert> &vert,
+	template <typename ... TT> t_mesh(t_store<t_vert> vert,
 	                                  TT && ... args) {
-		DATA.VERT = std::make_shared<std::vector<t_vert>>(vert);
+		DATA.VERT = std::make_shared<t_store<t_vert>>(
+			std::move(vert));
 		DATA.GRID = std::make_shared<t_grid>();
-		DATA.GRID->GRID = t_hand<M, 1>::make(
-			std::forward<TT>(args) ... );
+		DATA.GRID->GRID = std::make_shared<MESH::t_grid<M>>(
+			t_hand<M, 1>::make(std::forward<TT>(args) ... ));
 		init();
 	}
 
-	template <typename ... TT> t_mesh(std::vector<t_vert> &&vert,
-	                                  TT && ... args) {
-		DATA.VERT = std::make_shared<std::vector<t_vert>>(
+	//Shares the given grid (e.g. grid of other mesh, see share()) instead of copying it:
+	t_mesh(t_store<t_vert> vert, std::shared_ptr<const MESH::t_grid<M>> grid) {
+		DATA.VERT = std::make_shared<t_store<t_vert>>(
 			std::move(vert));
 		DATA.GRID = std::make_shared<t_grid>();
-		DATA.GRID->GRID = t_hand<M, 1>::make(
-			std::forward<TT>(args) ... );
+		DATA.GRID->GRID = std::move(grid);
 		init();
 	}
 
@@ -446,14 +742,14 @@ public:
 	auto mov(const t_vector<T, N> &dir) const { return t_expr<EXPR::t_expr<T, N>>(DATA).mov(dir); }
 
 	//Data access:
-	template <unsigned I> const std::vector<std::vector<int>> &link() const { return DATA.GRID->GRID.template link<I>(); }
+	template <unsigned I> const t_links &link() const { return DATA.GRID->GRID->template link<I>(); }
 	template <unsigned I> t_link<I> link(int i) const { return t_link<I>(*this, i); }
 
-	template <unsigned I> const std::vector<t_cell<I>> &cell() const { return DATA.GRID->GRID.template cell<I>(); }
-	const std::vector<t_body> &body() const { return cell<3>(); }
-	const std::vector<t_face> &face() const { return cell<2>(); }
-	const std::vector<t_edge> &edge() const { return cell<1>(); }
-	const std::vector<t_vert> &vert() const { return *DATA.VERT; }
+	template <unsigned I> const t_list<I> &cell() const { return DATA.GRID->GRID->template cell<I>(); }
+	const t_list<3> &body() const { return cell<3>(); }
+	const t_list<2> &face() const { return cell<2>(); }
+	const t_list<1> &edge() const { return cell<1>(); }
+	const t_store<t_vert> &vert() const { return *DATA.VERT; }
 
 	template <unsigned I> t_part<I> cell(int i) const { return t_part<I>(*this, i); }
 	t_part<3> body(int i) const { return cell<3>(i); }
@@ -461,13 +757,81 @@ public:
 	t_part<1> edge(int i) const { return cell<1>(i); }
 	t_part<0> vert(int i) const { return cell<0>(i); }
 
-	const MESH::t_grid<M> &grid() const { return DATA.GRID->GRID; }
+	const MESH::t_grid<M> &grid() const { return *DATA.GRID->GRID; }
 
+	//Grid of K-cells owned together with this mesh
+	//(for K = M - 1 links of its top level refer to M-cells of this mesh):
+	template <unsigned K = M> std::shared_ptr<const MESH::t_grid<K>> share() const {
+		return std::shared_ptr<const MESH::t_grid<K>>(
+			DATA.GRID->GRID, &DATA.GRID->GRID->template grid<K>());
+	}
+
+	//Search structures are built once on demand, so they can be requested from several threads:
 	const t_tree &tree() const {
-	if (DATA.TREE == nullptr) {
-	    DATA.TREE = std::make_shared<t_tree>(DATA.VERT->data(), DATA.VERT->size());
+	auto &cache = *DATA.CACHE;
+	std::call_once(cache.TREE_ONCE, [&] {
+	    cache.TREE = std::make_unique<t_tree>(DATA.VERT->data(), DATA.VERT->size());
+	});
+	return *cache.TREE;
+	}
+
+	//Builds search tree (if it is not built yet) with the given pool:
+	const t_tree &tree(TASK::t_pool &pool) const {
+	auto &cache = *DATA.CACHE;
+	std::call_once(cache.TREE_ONCE, [&] {
+	    cache.TREE = std::make_unique<t_tree>(DATA.VERT->data(), DATA.VERT->size(), pool);
+	});
+	return *cache.TREE;
+	}
+
+	//Hierarchy of bounding boxes of M-cells:
+	const t_bvh &bvh() const {
+	TASK::t_pool pool(1);
+	return bvh(pool);
+	}
+
+	//Builds hierarchy of boxes (if it is not built yet), boxes of cells are found with the given pool:
+	const t_bvh &bvh(TASK::t_pool &pool) const {
+	auto &cache = *DATA.CACHE;
+	std::call_once(cache.BVH_ONCE, [&] {
+	    cache.BVH = std::make_unique<t_bvh>(rect<M>(pool));
+	});
+	return *cache.BVH;
+	}
+
+	//Coordinate-wise copy of vertices for user loops (built once on demand and kept with the mesh;
+	//it doubles memory of vertices, so methods of METH never build or use it):
+	const t_axis &axis() const {
+	auto &cache = *DATA.CACHE;
+	std::call_once(cache.AXIS_ONCE, [&] {
+	    cache.AXIS = std::make_unique<t_axis>(DATA.VERT->data(), DATA.VERT->size());
+	});
+	return *cache.AXIS;
+	}
+
+	//Signed distances (vert - center) * normal for vertices of range [start, end) in precision of D
+	//(summed in the same order as in t_axis::dot, so both give the same values):
+	template <typename D> void dot(const t_vector<D, N> &center, const t_vector<D, N> &normal,
+	                               D *ans, size_t start, size_t end) const {
+		const t_vert *vert = DATA.VERT->data();
+		for (size_t i = start; i < end; ++ i) {
+			D sum = D(0);
+			for (int k = 0; k < N; ++ k) sum += (D(vert[i][k]) - center[k]) * normal[k];
+			ans[i] = sum;
+		}
 	}
-	return *DATA.TREE;
+	template <typename D> void dot(const t_vector<D, N> &center, const t_vector<D, N> &normal, D *ans) const {
+		dot(center, normal, ans, 0, DATA.VERT->size());
+	}
+
+	//Signed distances for vertices of the given index list:
+	void dot(const t_vert &center, const t_vert &normal, const int *index, T *ans, size_t num) const {
+		const t_vert *vert = DATA.VERT->data();
+		for (size_t i = 0; i < num; ++ i) {
+			T sum = T(0);
+			for (int k = 0; k < N; ++ k) sum += (vert[index[i]][k] - center[k]) * normal[k];
+			ans[i] = sum;
+		}
 	}
 
 	t_iter<M> begin() const {
@@ -479,12 +843,20 @@ public:
 	}
 
 private:
-	struct t_grid { MESH::t_grid<M> GRID; std::vector<int> ITEM; };
+	struct t_grid { std::shared_ptr<const MESH::t_grid<M>> GRID; std::vector<t_index> ITEM; };
+
+	//Structures built on demand over the same vertices (shared by copies of mesh):
+	struct t_cache {
+		std::once_flag TREE_ONCE, AXIS_ONCE, BVH_ONCE;
+		std::unique_ptr<t_tree> TREE;
+		std::unique_ptr<t_axis> AXIS;
+		std::unique_ptr<t_bvh> BVH;
+	};
 
 	struct t_data {
-		std::shared_ptr<std::vector<t_vert>> VERT;
+		std::shared_ptr<const t_store<t_vert>> VERT;
 		std::shared_ptr<t_grid> GRID;
-		std::shared_ptr<t_tree> TREE;
+		std::shared_ptr<t_cache> CACHE = std::make_shared<t_cache>();
 	};
 
 	template <typename _T, unsigned _N, unsigned _M>
@@ -509,7 +881,8 @@ private:
 			return t_expr<decltype(_expr.mov(args ...))>(_data, _expr.mov(std::forward<TT>(args) ...));
 		}
 
-		operator t_mesh() const { return t_mesh(_data, _expr); }
+		//Whole chain is folded into single affine map before applying to vertices:
+		operator t_mesh() const { return t_mesh(_data, _expr.affine()); }
 
 	private:
 		t_expr(const t_data &data, const E &expr):
@@ -522,25 +895,62 @@ private:
 	};
 
 	t_mesh(const t_data &data, auto &&func) {
-		DATA.VERT = std::make_shared<
-		    std::vector<t_vert>>(data.VERT->size());
-		DATA.GRID = data.GRID;
+		std::vector<t_vert> vert(data.VERT->size());
 		std::transform(
 		data.VERT->begin(), data.VERT->end(),
-		DATA.VERT->begin(), func
+		vert.begin(), func
 		);
+		DATA.VERT = std::make_shared<
+		    t_store<t_vert>>(std::move(vert));
+		DATA.GRID = data.GRID;
+	}
+
+	//Bounding boxes of K-cells are found level by level from boxes of their items:
+	template <unsigned K> std::vector<t_rect<T, N>> rect(TASK::t_pool &pool) const {
+		std::vector<t_rect<T, N>> ans;
+		if constexpr (K == 0) {
+			ans.resize(vert().size());
+			pool.run(ans.size(), [&](unsigned, size_t start, size_t end) {
+				for (size_t i = start; i < end; ++ i) ans[i] = t_rect<T, N>{vert()[i], vert()[i]};
+			});
+		}
+		else {
+			const auto item = rect<K - 1>(pool);
+			const auto &list = cell<K>();
+			ans.resize(list.size());
+			pool.run(ans.size(), [&](unsigned, size_t start, size_t end) {
+				for (size_t c = start; c < end; ++ c) {
+					t_rect<T, N> box = item[list[c][0]];
+					for (int i: list[c]) {
+						for (int k = 0; k < N; ++ k) {
+							box.min[k] = std::min(box.min[k], item[i].min[k]);
+							box.max[k] = std::max(box.max[k], item[i].max[k]);
+						}
+					}
+					ans[c] = box;
+				}
+			});
+		}
+		return ans;
+	}
+
+	template <unsigned ... K> void check(std::integer_sequence<unsigned, K ...>) const {
+		(checkIndex(DATA.GRID->GRID->template cell<K + 1>().size()), ...);
 	}
 
 	void init() {
+		//Indices of vertices and cells of every level must fit into the index type:
+		checkIndex(DATA.VERT->size());
+		check(std::make_integer_sequence<unsigned, M>());
 		DATA.GRID->ITEM.resize(
-		DATA.GRID->GRID.template cell<M>().size());
+		DATA.GRID->GRID->template cell<M>().size());
 		std::iota(
 		DATA.GRID->ITEM.begin(),
 		DATA.GRID->ITEM.end(),
 		0);
 	}
 
-	mutable t_data DATA;
+	t_data DATA;
 };
 
 //...
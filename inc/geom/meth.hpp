@@ -21,6 +21,13 @@
 #pragma once
 #include "base.hpp"
 #include "mesh.hpp"
+#include "task.hpp"
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#ifdef GEOM_STATS
+#include <chrono>
+#endif
 
 namespace GEOM {
 
@@ -33,6 +40,59 @@ template <unsigned N, unsigned M> struct t_sect_reduce { constexpr static int di
 
 constexpr int nullind = -1;
 
+#ifdef GEOM_STATS
+//Статистика последнего вызова getSection, getClipped или getProject в данном потоке
+//(собирается только при определенном GEOM_STATS, иначе вызовы не меняются):
+struct t_stats {
+
+	//Время этапов (с): 0 - классификация вершин, K - обработка K-ячеек с их ссылками:
+	std::vector<double> TIME;
+	//Число ячеек результата по уровням (0 - вершины):
+	std::vector<size_t> CELL;
+	//Полное время вызова (с):
+	double TOTAL = 0;
+	//Число классифицированных вершин и пересеченных ребер:
+	size_t VERT = 0;
+	size_t EDGE = 0;
+	//Прирост памяти рабочих массивов (байт), нулевой при их повторном использовании:
+	size_t ALLOC = 0;
+
+	void reset(unsigned num) {
+		TIME.assign(num + 1, 0);
+		CELL.assign(num + 1, 0);
+		TOTAL = 0;
+		VERT = EDGE = ALLOC = 0;
+	}
+
+	template <unsigned M> void count(const t_grid<M> &grid) {
+		CELL[M] = grid.template cell<M>().size();
+		if constexpr (M > 1) {
+			count(grid.template grid<M - 1>());
+		}
+	}
+};
+
+inline t_stats &getStats() {
+	static thread_local t_stats stats;
+	return stats;
+}
+
+//Измерение времени этапа:
+struct t_stats_timer {
+	double stop() {
+		const auto now = std::chrono::steady_clock::now();
+		const double ans = std::chrono::duration<double>(now - START).count();
+		START = now;
+		return ans;
+	}
+	std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+};
+
+#define __METH_STATS(...) __VA_ARGS__
+#else
+#define __METH_STATS(...)
+#endif
+
 //Метод проецирования сетки на подпространство:
 template <typename T, unsigned N,
                       unsigned M>
@@ -41,45 +101,245 @@ auto getProject(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis)
 	typedef t_mesh<T, N - 1, t_sect_reduce<N, M>::dim> t_projected_mesh;
 	typedef typename t_projected_mesh::t_vert t_projected_vert;
 
-	const std::vector<t_vector<T, N>> &old_vert = mesh.vert();
-	std::vector<t_projected_vert> new_vert(old_vert.size());
+	__METH_STATS(auto &stats = getStats(); t_stats_timer timer;)
+	__METH_STATS(stats.reset(t_sect_reduce<N, M>::dim);)
 
-	for (int i = 0; i < old_vert.size(); ++ i) {
-		new_vert[i] = basis.put(old_vert[i]);
+	const size_t num = mesh.vert().size();
+	std::vector<t_projected_vert> new_vert(num);
+	std::vector<T> new_vert_coord(num);
+
+	//Проецируем вершины покоординатно:
+	for (int k = 0; k < N - 1; ++ k) {
+		mesh.dot(basis.center(), basis[k], new_vert_coord.data());
+		for (int i = 0; i < new_vert.size(); ++ i) {
+			new_vert[i][k] = new_vert_coord[i];
+		}
 	}
 
-	return t_projected_mesh{
+	__METH_STATS(stats.TIME[0] = stats.TOTAL = timer.stop();)
+	__METH_STATS(stats.VERT = stats.CELL[0] = new_vert.size();)
+	__METH_STATS(stats.count(mesh.grid().template grid<t_sect_reduce<N, M>::dim>());)
+
+	//Топология не меняется, поэтому сетка разделяется с исходной:
+	return t_projected_mesh(
 	std::move(new_vert),
-	mesh.grid()
-	};
+	mesh.template share<t_sect_reduce<N, M>::dim>()
+	);
 }
 
+//Набор индексов подъячеек одной ячейки: индексы добавляются без проверок, затем упорядочиваются
+//с удалением повторов. Небольшие наборы хранятся в самом объекте, большие - в векторе, память
+//которого переиспользуется, поэтому один объект служит для всех ячеек части цикла:
+struct t_scratch {
 
-template <unsigned N> struct t_push {
+	static constexpr size_t LOCAL = 32;
 
-	void add(int val) { item.push_back(val); ++ pos; }
+	void clear() { SIZE = 0; HEAP.clear(); }
 
-	MESH::t_cell<N> item;
-	int pos = 0;
-};
+	void insert(int val) {
+		if (HEAP.empty() && (SIZE < LOCAL)) { DATA[SIZE ++] = val; return; }
+		if (HEAP.empty()) HEAP.assign(DATA.begin(), DATA.end());
+		HEAP.push_back(val); ++ SIZE;
+	}
+	template <typename I> void insert(I first, I last) {
+		for (; first != last; ++ first) insert(*first);
+	}
+
+	//Упорядочиваем и удаляем повторы:
+	void sort() {
+		int *ptr = data();
+		std::sort(ptr, ptr + SIZE);
+		SIZE = std::unique(ptr, ptr + SIZE) - ptr;
+		if (!HEAP.empty()) HEAP.resize(SIZE);
+	}
+
+	const int *begin() const { return data(); }
+	const int *end() const { return data() + SIZE; }
+	size_t size() const { return SIZE; }
 
-template <> struct t_push<1> {
+	//Память вектора (байт):
+	size_t capacity() const { return HEAP.capacity() * sizeof(int); }
 
-	void add(int val) { item[pos] = val; ++ pos; }
+private:
+	const int *data() const { return HEAP.empty()? DATA.data(): HEAP.data(); }
+	int *data() { return HEAP.empty()? DATA.data(): HEAP.data(); }
 
-	MESH::t_cell<1> item;
-	int pos = 0;
+	std::array<int, LOCAL> DATA;
+	std::vector<int> HEAP;
+	size_t SIZE = 0;
 };
 
+//Добавляем новую K-ячейку из упорядоченного набора индексов подъячеек:
+template <unsigned K> void pushItem(t_list<K> &list, const t_scratch &item) {
+	assert(item.size() > K);
+	if constexpr (K == 1) {
+		list.push_back(t_cell<1>{t_index(item.begin()[0]), t_index(item.begin()[1])});
+	}
+	else {
+		list.push_back(item);
+	}
+}
+
 enum class t_state { CROSS, LOWER, UPPER, INNER };
 
 typedef std::vector<int> t_child;
 
+//Рабочие массивы построения ячеек сечения по уровням:
+struct t_cell_work {
+
+	//Состояния ячеек уровня, их дочерние ячейки и номера новых ячеек:
+	struct t_level {
+		void reset(size_t num) {
+			STATE.resize(num);
+			if (CHILD.size() < num) CHILD.resize(num);
+			for (size_t i = 0; i < num; ++ i) CHILD[i].clear();
+			INDEX.assign(num, nullind);
+		}
+		std::vector<t_state> STATE;
+		std::vector<t_child> CHILD;
+		std::vector<int> INDEX;
+	};
+
+	//Уровни должны быть созданы до получения ссылок на них:
+	void init(unsigned num) {
+		if (LEVEL.size() < num) LEVEL.resize(num);
+	}
+	t_level &level(unsigned k) {
+		return LEVEL[k];
+	}
+
+	//Счетчики частей цикла:
+	std::vector<int> &count(unsigned k, unsigned num) {
+		COUNT[k].assign(num + 1, 0);
+		return COUNT[k];
+	}
+
+	//Списки новых ячеек и наборы индексов частей цикла:
+	template <unsigned K> std::vector<t_list<K>> &part(unsigned num) {
+		std::vector<t_list<K>> *list;
+		if constexpr (K == 1) list = &PART_EDGE; else list = &PART_CELL;
+		if (list->size() < num) list->resize(num);
+		for (unsigned k = 0; k < num; ++ k) (*list)[k].clear();
+		return *list;
+	}
+	std::vector<t_scratch> &scratch(unsigned num) {
+		if (SCRATCH.size() < num) SCRATCH.resize(num);
+		return SCRATCH;
+	}
+
+	//Память рабочих массивов (байт):
+	size_t capacity() const {
+		size_t ans = LEVEL.capacity() * sizeof(t_level);
+		for (const auto &level: LEVEL) {
+			ans += level.STATE.capacity() * sizeof(t_state);
+			ans += level.CHILD.capacity() * sizeof(t_child);
+			ans += level.INDEX.capacity() * sizeof(int);
+			for (const auto &child: level.CHILD) ans += child.capacity() * sizeof(int);
+		}
+		for (const auto &count: COUNT) ans += count.capacity() * sizeof(int);
+		for (const auto &list: PART_EDGE) ans += list.capacity() * sizeof(t_cell<1>);
+		for (const auto &list: PART_CELL) {
+			ans += list.offs().capacity() * sizeof(size_t);
+			ans += list.item().capacity() * sizeof(int);
+		}
+		for (const auto &item: SCRATCH) ans += item.capacity();
+		return ans;
+	}
+
+private:
+	std::vector<t_level> LEVEL;
+	std::array<std::vector<int>, 2> COUNT;
+	std::vector<t_list<1>> PART_EDGE;
+	std::vector<t_list<2>> PART_CELL;
+	std::vector<t_scratch> SCRATCH;
+};
+
+//Рабочие массивы сечения и отсечения. Один объект можно передавать в getSection и getClipped
+//при многократных вызовах: массивы только очищаются, их память сохраняется, поэтому после
+//первых вызовов память выделяется лишь под результат. Тип T задает точность классификации
+//вершин и вычисления точек пересечения: он может быть выше точности вершин сетки
+//(например, вершины хранятся во float, а расстояния считаются в double).
+template <typename T> struct t_sect_work: t_cell_work {
+
+	//Допуск, в пределах которого вершина лежит на гиперплоскости:
+	T EPS = getEpsilon<T>();
+
+	//Расстояния до вершин, их состояния и новые номера:
+	std::vector<T> DIST;
+	std::vector<int> STATE;
+	std::vector<int> INDEX;
+
+	size_t capacity() const {
+		return t_cell_work::capacity() + DIST.capacity() * sizeof(T) +
+		       (STATE.capacity() + INDEX.capacity()) * sizeof(int);
+	}
+};
+
+//Пакетная классификация вершин относительно гиперплоскости:
+//расстояния считаются одним проходом по вершинам (или по координатным
+//массивам, если они уже построены), затем индексы сохраняемых вершин
+//находятся префиксной суммой.
+template <bool SLICE_ONLY, typename T, typename D, unsigned N, unsigned M>
+int getVertState(const t_mesh<T, N, M> &mesh, const t_vector<D, N> &center,
+                                              const t_vector<D, N> &normal,
+                 t_sect_work<D> &work,
+                 TASK::t_pool &pool) {
+
+	const size_t num = mesh.vert().size();
+	auto &vert_dist = work.DIST;
+	auto &vert_state = work.STATE;
+	auto &vert_index = work.INDEX;
+	vert_dist.resize(num);
+	vert_state.resize(num);
+	vert_index.resize(num);
+
+	auto &part_count = work.count(0, pool.part(num));
+	const D eps = work.EPS;
+
+	pool.run(num, [&](unsigned part, size_t start, size_t end) {
+
+		mesh.dot(center, normal, vert_dist.data(), start, end);
+
+		int count = 0;
+		for (size_t i = start; i < end; ++ i) {
+			const D p = vert_dist[i];
+			vert_state[i] = int(p >= eps) - int(p <= - eps);
+			count += SLICE_ONLY? (vert_state[i] == 0): (vert_state[i] >= 0);
+		}
+		part_count[part + 1] = count;
+	});
+
+	std::partial_sum(part_count.begin(), part_count.end(), part_count.begin());
+
+	pool.run(num, [&](unsigned part, size_t start, size_t end) {
+
+		int count = part_count[part];
+		for (size_t i = start; i < end; ++ i) {
+			const int keep = SLICE_ONLY? (vert_state[i] == 0): (vert_state[i] >= 0);
+			vert_index[i] = keep? count: nullind;
+			count += keep;
+		}
+	});
+
+	return part_count.back();
+}
+
+//Положение ребра по состояниям его вершин:
+inline t_state getEdgeState(int a, int b) {
+	if (a * b < 0) return t_state::CROSS;
+	if (a + b < 0) return t_state::LOWER;
+	if (a + b > 0) return t_state::UPPER;
+	return t_state::INNER;
+}
+
+//NOTE: Каждый уровень обрабатывается двумя проходами по непрерывным частям списка ячеек: первый
+//находит состояния ячеек и считает новые ячейки каждой части, второй строит новые ячейки каждой
+//части в её собственном списке по известным смещениям. Поэтому результат не зависит от числа потоков.
 template <unsigned N, unsigned M, unsigned K, bool SLICE_ONLY = false>
 struct t_sect_builder {
 
-	t_sect_builder(const t_grid<N> &_old_grid, t_grid<M> &_new_grid):
-	               old_grid(_old_grid), new_grid(_new_grid) {}
+	t_sect_builder(const t_grid<N> &_old_grid, t_grid<M> &_new_grid, TASK::t_pool &_pool, t_cell_work &_work):
+	               old_grid(_old_grid), new_grid(_new_grid), pool(_pool), work(_work) {}
 
 	void make_new_item(const std::vector<t_state> &old_item_state,
 	                   const std::vector<t_child> &new_item_child,
@@ -91,44 +351,72 @@ struct t_sect_builder {
 		const auto &old_cell = old_grid.template cell<K + 1>();
 		auto &new_item = new_grid.template cell<K>();
 
-		for (int i = 0; i < old_cell.size(); ++ i) {
-
-			//Проверяем положение ячейки относительно подпространства:
-			size_t cross = 0, lower = 0, upper = 0, inner = 0;
-			for (int c: old_cell[i]) {
-				if (old_item_state[c] == t_state::CROSS) { ++ cross; }
-				if (old_item_state[c] == t_state::LOWER) { ++ lower; }
-				if (old_item_state[c] == t_state::UPPER) { ++ upper; }
-				if (old_item_state[c] == t_state::INNER) {
-					assert(new_item_index[c] != nullind);
-					new_cell_child[i].
-					push_back(new_item_index[c]);
-					++ inner;
+		const unsigned part_num = pool.part(old_cell.size());
+		auto &part_count = work.count(0, part_num);
+
+		pool.run(old_cell.size(), [&](unsigned part, size_t start, size_t end) {
+
+			for (size_t i = start; i < end; ++ i) {
+
+				//Проверяем положение ячейки относительно подпространства:
+				size_t cross = 0, lower = 0, upper = 0, inner = 0;
+				for (int c: old_cell[i]) {
+					if (old_item_state[c] == t_state::CROSS) { ++ cross; }
+					if (old_item_state[c] == t_state::LOWER) { ++ lower; }
+					if (old_item_state[c] == t_state::UPPER) { ++ upper; }
+					if (old_item_state[c] == t_state::INNER) {
+						assert(new_item_index[c] != nullind);
+						new_cell_child[i].
+						push_back(new_item_index[c]);
+						++ inner;
+					}
 				}
+				if (inner == old_cell[i].size()) old_cell_state[i] = t_state::INNER;
+				else
+				if (cross || (upper && lower)) old_cell_state[i] = t_state::CROSS;
+				else {
+					old_cell_state[i] = lower? t_state::LOWER: t_state::UPPER;
+				}
+
+				if (old_cell_state[i] == t_state::CROSS) ++ part_count[part + 1];
 			}
-			if (inner == old_cell[i].size()) old_cell_state[i] = t_state::INNER;
-			else
-			if (cross || (upper && lower)) old_cell_state[i] = t_state::CROSS;
-			else {
-				old_cell_state[i] = lower? t_state::LOWER: t_state::UPPER;
-			}
+		});
 
-			if (old_cell_state[i] != t_state::CROSS) continue;
+		std::partial_sum(part_count.begin(), part_count.end(), part_count.begin());
 
-			//Добавляем новую подъячейку:
-			std::set<int> item;
-			for (int c: old_cell[i]) for (int k: new_item_child[c]) item.insert(k);
-			t_push<K> push;
-			for (int k: item) push.add(k);
+		auto &part_item = work.template part<K>(part_num);
+		auto &part_scratch = work.scratch(part_num);
+		const int base = new_item.size();
 
-			assert(push.pos > K);
+		pool.run(old_cell.size(), [&](unsigned part, size_t start, size_t end) {
 
-			new_cell_child[i].push_back(
-				new_item.size()
-			);
-			new_item.push_back(
-			push.item
-			);
+			auto &item_list = part_item[part];
+			item_list.reserve(part_count[part + 1] - part_count[part]);
+			auto &item = part_scratch[part];
+
+			for (size_t i = start; i < end; ++ i) {
+
+				if (old_cell_state[i] != t_state::CROSS) continue;
+
+				//Добавляем новую подъячейку:
+				item.clear();
+				for (int c: old_cell[i]) item.insert(new_item_child[c].begin(), new_item_child[c].end());
+				item.sort();
+
+				new_cell_child[i].push_back(
+					base + part_count[part] + item_list.size()
+				);
+				pushItem<K>(
+				item_list, item
+				);
+			}
+		});
+
+		//Сшиваем результаты частей:
+		new_item.reserve(base + part_count.back());
+		for (unsigned part = 0; part < part_num; ++ part)
+		for (const auto &item: part_item[part]) {
+			new_item.push_back(item);
 		}
 	}
 
@@ -142,30 +430,60 @@ struct t_sect_builder {
 		const auto &old_cell = old_grid.template cell<K + 1>();
 		auto &new_cell = new_grid.template cell<K + 1>();
 
-		for (int i = 0; i < old_cell.size(); ++ i) {
-
+		auto keep = [&](size_t i) {
 			if (!SLICE_ONLY) {
-				if ((old_cell_state[i] != t_state::INNER) && (old_cell_state[i] != t_state::UPPER) &&
-				    (old_cell_state[i] != t_state::CROSS)) continue;
+				return (old_cell_state[i] == t_state::INNER) || (old_cell_state[i] == t_state::UPPER) ||
+				       (old_cell_state[i] == t_state::CROSS);
 			}
 			else {
-				if (old_cell_state[i] != t_state::INNER) continue;
+				return (old_cell_state[i] == t_state::INNER);
 			}
+		};
+
+		const unsigned part_num = pool.part(old_cell.size());
+		auto &part_count = work.count(0, part_num);
+
+		pool.run(old_cell.size(), [&](unsigned part, size_t start, size_t end) {
+			for (size_t i = start; i < end; ++ i) part_count[part + 1] += keep(i);
+		});
+
+		std::partial_sum(part_count.begin(), part_count.end(), part_count.begin());
+
+		auto &part_cell = work.template part<K + 1>(part_num);
+		auto &part_scratch = work.scratch(part_num);
+		const int base = new_cell.size();
+
+		pool.run(old_cell.size(), [&](unsigned part, size_t start, size_t end) {
+
+			auto &cell_list = part_cell[part];
+			cell_list.reserve(part_count[part + 1] - part_count[part]);
+			auto &item = part_scratch[part];
 
-			std::set<int> item;
-			if (!SLICE_ONLY) for (int k: new_cell_child[i]) item.insert(k);
-			for (int c: old_cell[i]) {
-			int k = new_item_index[c]; if (k != nullind) item.insert(k);
+			for (size_t i = start; i < end; ++ i) {
+
+				if (!keep(i)) continue;
+
+				item.clear();
+				if (!SLICE_ONLY) item.insert(new_cell_child[i].begin(), new_cell_child[i].end());
+				for (int c: old_cell[i]) {
+				int k = new_item_index[c]; if (k != nullind) item.insert(k);
+				}
+				item.sort();
+
+				//Добавляем новую ячейку:
+				new_cell_index[i] =
+				base + part_count[part] + cell_list.size();
+				cell_list.push_back(
+				item
+				);
 			}
-			t_cell<K + 1> cell;
-			for (int k: item) cell.push_back(k);
-
-			//Добавляем новую ячейку:
-			new_cell_index[i] =
-			new_cell.size();
-			new_cell.push_back(
-			cell
-			);
+		});
+
+		//Сшиваем результаты частей:
+		new_cell.reserve(base + part_count.back());
+		for (unsigned part = 0; part < part_num; ++ part)
+		for (const auto &cell: part_cell[part]) {
+			new_cell.push_back(cell);
 		}
 	}
 
@@ -176,11 +494,13 @@ struct t_sect_builder {
 		const auto &old_cell = old_grid.template cell<K + 1>();
 		auto &new_item = new_grid.template cell<K>();
 
-		std::vector<t_state> old_cell_state(old_cell.size());
-		std::vector<t_child> new_cell_child(old_cell.size());
-		std::vector<int> new_cell_index(
-			old_cell.size(), nullind
-		);
+		auto &level = work.level(K + 1);
+		level.reset(old_cell.size());
+		auto &old_cell_state = level.STATE;
+		auto &new_cell_child = level.CHILD;
+		auto &new_cell_index = level.INDEX;
+
+		__METH_STATS(t_stats_timer timer;)
 
 		//Заполняем новые подъячейки меньшей размерности:
 		make_new_item(
@@ -189,139 +509,173 @@ struct t_sect_builder {
 		);
 		//Заполняем новые ячейки из подъячеек:
 		t_sect_builder<N, M, (K < M)? (K): (N), SLICE_ONLY>
-		(old_grid, new_grid).make_new_cell(
+		(old_grid, new_grid, pool, work).make_new_cell(
 			old_item_state, new_item_child, new_item_index,
 			old_cell_state, new_cell_child, new_cell_index
 		);
+		__METH_STATS(getStats().TIME[K + 1] += timer.stop();)
+
 		//Вызываемся рекурсивно вверх:
 		t_sect_builder<N, M, K + 1, SLICE_ONLY>
-		(old_grid, new_grid).make(
+		(old_grid, new_grid, pool, work).make(
 			old_cell_state, new_cell_child, new_cell_index
 		);
 
+		__METH_STATS(timer.stop();)
 		//Заполняем обратные ссылки:
 		t_hand<M, K>::fill(
-		new_grid, new_item
+		new_grid, new_item, pool
 		);
+		__METH_STATS(getStats().TIME[K] += timer.stop();)
 	}
 
 private:
 	const t_grid<N> &old_grid;
 	t_grid<M> &new_grid;
+	TASK::t_pool &pool;
+	t_cell_work &work;
 };
 
 template <unsigned N, unsigned M, bool SLICE_ONLY>
 struct t_sect_builder<N, M, N, SLICE_ONLY> {
 
-	template <typename ... TT> t_sect_builder(TT ... args) {}
+	template <typename ... TT> t_sect_builder(TT && ...) {}
 	template <typename ... TT>
-	void make_new_cell(TT ... args) {}
+	void make_new_cell(TT && ...) {}
 	template <typename ... TT>
-	void make(TT ... args) {}
+	void make(TT && ...) {}
 
 };
 
 //Метод отсечения гиперплоскостью:
-template <typename T, unsigned N,
-                      unsigned M>
-auto getClipped(const t_mesh<T, N, M> &mesh, const t_vector<T, N> &center,
-                                             const t_vector<T, N> &direct) {
+template <typename T, typename D, unsigned N,
+                                  unsigned M>
+auto getClipped(const t_mesh<T, N, M> &mesh, const t_vector<D, N> &center,
+                                             const t_vector<D, N> &direct, TASK::t_pool &pool, t_sect_work<D> &work) {
+
+	__METH_STATS(auto &stats = getStats(); t_stats_timer timer, total;)
+	__METH_STATS(stats.reset(M); stats.ALLOC = work.capacity();)
 
 	//Разделяем вершины относительно подпространства:
 	const auto &old_vert = mesh.vert(); std::vector<t_vert<T, N>> new_vert;
-
-	std::vector<int> new_vert_index(old_vert.size(), nullind);
-	std::vector<int> old_vert_state(old_vert.size());
 	const auto &normal = direct / direct.len();
 
-	for (int i = 0; i < old_vert.size(); ++ i) {
-
-		const T p = (old_vert[i] - center) * normal;
-
-		if (std::abs(p) < MATH_EPSILON) {
-			new_vert_index[i] = new_vert.size();
-			new_vert.push_back(old_vert[i]);
-			old_vert_state[i] = +0;
-		}
-		else
-		if (p > 0) {
-			new_vert_index[i] = new_vert.size();
-			new_vert.push_back(old_vert[i]);
-			old_vert_state[i] = +1;
+	const auto &old_vert_state = work.STATE;
+	const auto &new_vert_index = work.INDEX;
+
+	new_vert.resize(getVertState<false>(
+		mesh, center, normal,
+		work,
+		pool
+	));
+	pool.run(old_vert.size(), [&](unsigned, size_t start, size_t end) {
+		for (size_t i = start; i < end; ++ i) {
+			if (new_vert_index[i] != nullind) new_vert[new_vert_index[i]] = old_vert[i];
 		}
-		else
-		if (p < 0) {
-			old_vert_state[i] = -1;
-		}
-	}
+	});
+	__METH_STATS(stats.TIME[0] += timer.stop(); stats.VERT = old_vert.size();)
 
 	//Разрезаем ребра подпространством:
 	const auto &old_grid = mesh.grid(); t_grid<M> new_grid;
 	const auto &old_edge = old_grid.template cell<1>();
 	auto &new_edge = new_grid.template cell<1>();
 
-	std::vector<t_state> old_edge_state(old_edge.size());
-	std::vector<t_child> new_edge_child(old_edge.size());
-	std::vector<int> new_edge_index(
-		old_edge.size(), nullind
-	);
+	work.init(M + 1);
+	auto &level = work.level(1);
+	level.reset(old_edge.size());
+	auto &old_edge_state = level.STATE;
+	auto &new_edge_child = level.CHILD;
+	auto &new_edge_index = level.INDEX;
 
-	for (int i = 0; i < old_edge.size(); ++ i) {
+	const unsigned part_num = pool.part(old_edge.size());
+	auto &part_vert = work.count(0, part_num);
+	auto &part_edge = work.count(1, part_num);
 
-		const auto &edge = old_edge[i]; const int a = edge[0], b = edge[1];
+	pool.run(old_edge.size(), [&](unsigned part, size_t start, size_t end) {
 
-		if (old_vert_state[a] == 0) {
-			new_edge_child[i].push_back(new_vert_index[a]);
-		}
-		if (old_vert_state[b] == 0) {
-			new_edge_child[i].push_back(new_vert_index[b]);
-		}
-		if (old_vert_state[a] * old_vert_state[b] < 0)
-			old_edge_state[i] = t_state::CROSS;
-		else
-		if (old_vert_state[a] + old_vert_state[b] < 0)
-			old_edge_state[i] = t_state::LOWER;
-		else
-		if (old_vert_state[a] + old_vert_state[b] > 0)
-			old_edge_state[i] = t_state::UPPER;
-		else {
-			old_edge_state[i] = t_state::INNER;
-		}
+		for (size_t i = start; i < end; ++ i) {
 
-		if (old_edge_state[i] == t_state::CROSS) {
-			const auto &pa = old_vert[a], &pb = old_vert[b];
-			T p = - ((pa - center) * normal) /
-			        ((pb - pa) * normal);
-			//Add new vert:
-			new_edge_child[i].push_back(new_vert.size());
-			new_vert.push_back(
-			pa + p * (pb - pa)
+			const auto &edge = old_edge[i]; const int a = edge[0], b = edge[1];
+
+			if (old_vert_state[a] == 0) {
+				new_edge_child[i].push_back(new_vert_index[a]);
+			}
+			if (old_vert_state[b] == 0) {
+				new_edge_child[i].push_back(new_vert_index[b]);
+			}
+			old_edge_state[i] = getEdgeState(
+				old_vert_state[a], old_vert_state[b]
 			);
-			//Add new edge (short of edge):
-			new_edge_index[i] = new_edge.size();
-			int va = (old_vert_state[a] > 0)?
-			          new_vert_index[a]:
-			          new_vert.size() - 1;
-			int vb = (old_vert_state[b] > 0)?
-			          new_vert_index[b]:
-			          new_vert.size() - 1;
-			new_edge.push_back({va, vb});
-		}
-		if (old_edge_state[i] == t_state::INNER ||
-		    old_edge_state[i] == t_state::UPPER) {
-			//Add new edge:
-			new_edge_index[i] = new_edge.size();
-			new_edge.push_back({
-			new_vert_index[a],
-			new_vert_index[b]
-			});
+
+			if (old_edge_state[i] == t_state::CROSS) {
+				++ part_vert[part + 1];
+				++ part_edge[part + 1];
+			}
+			if (old_edge_state[i] == t_state::INNER ||
+			    old_edge_state[i] == t_state::UPPER) {
+				++ part_edge[part + 1];
+			}
 		}
-	}
+	});
+
+	std::partial_sum(part_vert.begin(), part_vert.end(), part_vert.begin());
+	std::partial_sum(part_edge.begin(), part_edge.end(), part_edge.begin());
+
+	const int base = new_vert.size();
+	new_vert.resize(base + part_vert.back());
+	new_edge.resize(part_edge.back());
+
+	pool.run(old_edge.size(), [&](unsigned part, size_t start, size_t end) {
+
+		int v = base + part_vert[part], e = part_edge[part];
+
+		for (size_t i = start; i < end; ++ i) {
+
+			const auto &edge = old_edge[i]; const int a = edge[0], b = edge[1];
+
+			if (old_edge_state[i] == t_state::CROSS) {
+				const t_vector<D, N> pa(old_vert[a]), pb(old_vert[b]);
+				D p = - ((pa - center) * normal) /
+				        ((pb - pa) * normal);
+				//Add new vert:
+				new_edge_child[i].push_back(v);
+				new_vert[v] = t_vert<T, N>(
+				pa + p * (pb - pa));
+				//Add new edge (short of edge):
+				new_edge_index[i] = e;
+				int va = (old_vert_state[a] > 0)?
+				          new_vert_index[a]: v;
+				int vb = (old_vert_state[b] > 0)?
+				          new_vert_index[b]: v;
+				new_edge[e ++] = {t_index(va), t_index(vb)};
+				++ v;
+			}
+			if (old_edge_state[i] == t_state::INNER ||
+			    old_edge_state[i] == t_state::UPPER) {
+				//Add new edge:
+				new_edge_index[i] = e;
+				new_edge[e ++] = {
+				t_index(new_vert_index[a]),
+				t_index(new_vert_index[b])
+				};
+			}
+		}
+	});
+
+	__METH_STATS(stats.TIME[1] += timer.stop(); stats.EDGE = part_vert.back();)
 
 	//Вызываемся рекурсивно вверх:
-	t_sect_builder<M, M, 1, false>(old_grid, new_grid).make(
+	t_sect_builder<M, M, 1, false>(old_grid, new_grid, pool, work).make(
 	old_edge_state, new_edge_child, new_edge_index
 	);
+	__METH_STATS(timer.stop();)
+	//Ссылки на ячейки старшей размерности:
+	t_hand<M, M>::fill(
+	new_grid, new_grid.template cell<M>(), pool
+	);
+	__METH_STATS(stats.TIME[M] += timer.stop(); stats.TOTAL = total.stop();)
+	__METH_STATS(stats.CELL[0] = new_vert.size(); stats.count(new_grid);)
+	__METH_STATS(stats.ALLOC = work.capacity() - stats.ALLOC;)
 
 	return t_mesh<T, N, M>(
 	std::move(new_vert),
@@ -329,108 +683,874 @@ auto getClipped(const t_mesh<T, N, M> &mesh, const t_vector<T, N> &center,
 	);
 }
 
-//Метод сечения гиперплоскостью:
 template <typename T, unsigned N,
                       unsigned M>
-auto getSection(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis) {
+auto getClipped(const t_mesh<T, N, M> &mesh, const t_vector<T, N> &center,
+                                             const t_vector<T, N> &direct, TASK::t_pool &pool) {
+	t_sect_work<T> work;
+	return getClipped(
+	mesh, center, direct, pool, work
+	);
+}
+
+template <typename T, unsigned N,
+                      unsigned M>
+auto getClipped(const t_mesh<T, N, M> &mesh, const t_vector<T, N> &center,
+                                             const t_vector<T, N> &direct) {
+	TASK::t_pool pool(1);
+	return getClipped(
+	mesh, center, direct, pool
+	);
+}
+
+//Метод сечения гиперплоскостью:
+template <typename T, typename D, unsigned N,
+                                  unsigned M>
+auto getSection(const t_mesh<T, N, M> &mesh, const t_basis<D, N, N - 1> &basis, TASK::t_pool &pool,
+                t_sect_work<D> &work) {
 
 	typedef t_mesh<T, N - 1, t_sect_reduce<N, M>::dim> t_sliced_mesh;
 	typedef typename t_sliced_mesh::t_vert t_sliced_vert;
 	typedef t_grid<t_sect_reduce<N, M>::dim> t_sliced_grid;
 
-	t_basis<T, N, N> extBasis = basis.template ext<N>();
+	t_basis<D, N, N> extBasis = basis.template ext<N>();
 	const auto &center = extBasis.center();
 	const auto &normal = extBasis[N - 1];
 
+	__METH_STATS(auto &stats = getStats(); t_stats_timer timer, total;)
+	__METH_STATS(stats.reset(M); stats.ALLOC = work.capacity();)
+
 	//Разделяем вершины относительно подпространства:
 	const auto &old_vert = mesh.vert();
 	std::vector<t_sliced_vert> new_vert;
 
-	std::vector<int> new_vert_index(old_vert.size(), nullind);
-	std::vector<int> old_vert_state(old_vert.size());
+	const auto &old_vert_state = work.STATE;
+	const auto &new_vert_index = work.INDEX;
+
+	new_vert.resize(getVertState<true>(
+		mesh, center, normal,
+		work,
+		pool
+	));
+	pool.run(old_vert.size(), [&](unsigned, size_t start, size_t end) {
+		for (size_t i = start; i < end; ++ i) {
+			if (new_vert_index[i] != nullind) new_vert[new_vert_index[i]] = t_sliced_vert(basis.put(t_vector<D, N>(old_vert[i])));
+		}
+	});
+	__METH_STATS(stats.TIME[0] += timer.stop(); stats.VERT = old_vert.size();)
 
-	for (int i = 0; i < old_vert.size(); ++ i) {
+	//Разрезаем ребра подпространством:
+	const auto &old_grid = mesh.grid(); t_sliced_grid new_grid;
+	const auto &old_edge = old_grid.template cell<1>();
+	auto &new_edge = new_grid.template cell<1>();
+
+	work.init(M + 1);
+	auto &level = work.level(1);
+	level.reset(old_edge.size());
+	auto &old_edge_state = level.STATE;
+	auto &new_edge_child = level.CHILD;
+	auto &new_edge_index = level.INDEX;
+
+	const unsigned part_num = pool.part(old_edge.size());
+	auto &part_vert = work.count(0, part_num);
+	auto &part_edge = work.count(1, part_num);
+
+	pool.run(old_edge.size(), [&](unsigned part, size_t start, size_t end) {
 
-		const T p = (old_vert[i] - center) * normal;
+		for (size_t i = start; i < end; ++ i) {
 
-		if (std::abs(p) < MATH_EPSILON) {
-			new_vert_index[i] = new_vert.size();
-			new_vert.push_back(
-				basis.put(old_vert[i])
+			const auto &edge = old_edge[i]; const int a = edge[0], b = edge[1];
+
+			if (old_vert_state[a] == 0) {
+				new_edge_child[i].push_back(new_vert_index[a]);
+			}
+			if (old_vert_state[b] == 0) {
+				new_edge_child[i].push_back(new_vert_index[b]);
+			}
+			old_edge_state[i] = getEdgeState(
+				old_vert_state[a], old_vert_state[b]
 			);
-			old_vert_state[i] = +0;
-		}
-		if (p > 0) {
-			old_vert_state[i] = +1;
+
+			if (old_edge_state[i] == t_state::CROSS) ++ part_vert[part + 1];
+			if (old_edge_state[i] == t_state::INNER) ++ part_edge[part + 1];
 		}
-		if (p < 0) {
-			old_vert_state[i] = -1;
+	});
+
+	std::partial_sum(part_vert.begin(), part_vert.end(), part_vert.begin());
+	std::partial_sum(part_edge.begin(), part_edge.end(), part_edge.begin());
+
+	const int base = new_vert.size();
+	new_vert.resize(base + part_vert.back());
+	new_edge.resize(part_edge.back());
+
+	pool.run(old_edge.size(), [&](unsigned part, size_t start, size_t end) {
+
+		int v = base + part_vert[part], e = part_edge[part];
+
+		for (size_t i = start; i < end; ++ i) {
+
+			const auto &edge = old_edge[i]; const int a = edge[0], b = edge[1];
+
+			if (old_edge_state[i] == t_state::CROSS) {
+				const t_vector<D, N> pa(old_vert[a]), pb(old_vert[b]);
+				D p = - ((pa - center) * normal) /
+				        ((pb - pa) * normal);
+				//Add new vert:
+				new_edge_child[i].push_back(v);
+				new_vert[v ++] = t_sliced_vert(
+				basis.put(pa + p * (pb - pa)));
+			}
+			if (old_edge_state[i] == t_state::INNER) {
+				//Add new edge:
+				new_edge_index[i] = e;
+				new_edge[e ++] = {
+				t_index(new_vert_index[a]),
+				t_index(new_vert_index[b])
+				};
+			}
 		}
+	});
+
+	__METH_STATS(stats.TIME[1] += timer.stop(); stats.EDGE = part_vert.back();)
+
+	//Вызываемся рекурсивно вверх:
+	constexpr unsigned L = t_sect_reduce<N, M>::dim;
+	t_sect_builder<M, L, 1, true>(old_grid, new_grid, pool, work
+	).make(
+	old_edge_state, new_edge_child, new_edge_index
+	);
+	__METH_STATS(timer.stop();)
+	//Ссылки на ячейки старшей размерности (иначе заполнены при сечении):
+	if (L == M) {
+		t_hand<L, L>::fill(
+		new_grid, new_grid.template cell<L>(), pool
+		);
 	}
+	__METH_STATS(stats.TIME[L] += timer.stop(); stats.TOTAL = total.stop();)
+	__METH_STATS(stats.CELL[0] = new_vert.size(); stats.count(new_grid);)
+	__METH_STATS(stats.ALLOC = work.capacity() - stats.ALLOC;)
 
-	//Разрезаем ребра подпространством:
-	const auto &old_grid = mesh.grid(); t_sliced_grid new_grid;
-	const auto &old_edge = old_grid.template cell<1>();
-	auto &new_edge = new_grid.template cell<1>();
+	return t_sliced_mesh(
+	std::move(new_vert),
+	new_grid
+	);
+}
 
-	std::vector<t_state> old_edge_state(old_edge.size());
-	std::vector<t_child> new_edge_child(old_edge.size());
-	std::vector<int> new_edge_index(
-		old_edge.size(), nullind
+template <typename T, unsigned N,
+                      unsigned M>
+auto getSection(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis, TASK::t_pool &pool) {
+	t_sect_work<T> work;
+	return getSection(
+	mesh, basis, pool, work
 	);
+}
+
+template <typename T, unsigned N,
+                      unsigned M>
+auto getSection(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis) {
+	TASK::t_pool pool(1);
+	return getSection(
+	mesh, basis, pool
+	);
+}
 
-	for (int i = 0; i < old_edge.size(); ++ i) {
+//Заполняем обратные ссылки всех уровней сетки:
+template <unsigned N, unsigned K = 1> void fillLinks(t_grid<N> &grid, TASK::t_pool &pool) {
+	t_hand<N, K>::fill(grid, grid.template cell<K>(), pool);
+	if constexpr (K < N) {
+		fillLinks<N, K + 1>(grid, pool);
+	}
+}
 
-		const auto &edge = old_edge[i]; const int a = edge[0], b = edge[1];
+//Сечение гиперплоскостью, обновляемое при её движении. Состояния вершин и ячеек хранятся
+//между вызовами. Расстояния до всех вершин пересчитываются при каждом вызове (этот проход
+//не инкрементален), инкрементально лишь перестроение ячеек: пересчитываются только ячейки,
+//содержащие вершины со сменившимся знаком (по обратным ссылкам), а новая сетка собирается
+//только из ячеек, которые пересекают подпространство или касаются его. Если знаки вершин
+//не изменились, сетка предыдущего сечения используется повторно и пересчитываются только
+//вершины. Рабочие массивы сохраняются между вызовами, память выделяется лишь под результат.
+//Результат совпадает с getSection.
+template <typename T, unsigned N, unsigned M>
+struct t_section {
 
-		if (old_vert_state[a] == 0) {
-			new_edge_child[i].push_back(new_vert_index[a]);
-		}
-		if (old_vert_state[b] == 0) {
-			new_edge_child[i].push_back(new_vert_index[b]);
+	static constexpr unsigned L = t_sect_reduce<N, M>::dim;
+
+	typedef t_mesh<T, N - 1, L> t_sliced_mesh;
+	typedef typename t_sliced_mesh::t_vert t_sliced_vert;
+
+	//eps - допуск, в пределах которого вершина лежит на гиперплоскости:
+	explicit t_section(const t_mesh<T, N, M> &_mesh, T eps = getEpsilon<T>()): MESH(_mesh), EPS(eps) {
+		init<0>();
+	}
+
+	const t_sliced_mesh &update(const t_basis<T, N, N - 1> &basis, TASK::t_pool &pool) {
+
+		t_basis<T, N, N> extBasis = basis.template ext<N>();
+		const auto &center = extBasis.center();
+		const auto &normal = extBasis[N - 1];
+
+		//Пересчитываем расстояния и находим вершины со сменившимся знаком:
+		const unsigned part_num = pool.part(VERT_DIST.size());
+		if (PART.size() < part_num) PART.resize(part_num);
+		pool.run(VERT_DIST.size(), [&](unsigned part, size_t start, size_t end) {
+			auto &list = PART[part];
+			list.clear();
+			MESH.dot(center, normal, VERT_DIST.data(), start, end);
+			for (size_t i = start; i < end; ++ i) {
+				const T p = VERT_DIST[i];
+				const int state = int(p >= EPS) - int(p <= - EPS);
+				if (FIRST || (state != VERT_STATE[i])) list.push_back(i);
+				VERT_STATE[i] = state;
+			}
+		});
+		auto &vert = CHANGE[0];
+		vert.clear();
+		for (unsigned part = 0; part < part_num; ++ part) {
+			vert.insert(vert.end(), PART[part].begin(), PART[part].end());
 		}
-		if (old_vert_state[a] * old_vert_state[b] < 0)
-			old_edge_state[i] = t_state::CROSS;
-		else
-		if (old_vert_state[a] + old_vert_state[b] < 0)
-			old_edge_state[i] = t_state::LOWER;
-		else
-		if (old_vert_state[a] + old_vert_state[b] > 0)
-			old_edge_state[i] = t_state::UPPER;
-		else {
-			old_edge_state[i] = t_state::INNER;
+
+		const bool same = !FIRST && vert.empty();
+		if (!same) {
+			//Вершины, лежащие в подпространстве:
+			auto &list = LIST[0];
+			list.erase(std::remove_if(list.begin(), list.end(), [this](int i) { return VERT_STATE[i] != 0; }), list.end());
+			ADD.clear();
+			for (int i: vert) if ((VERT_STATE[i] == 0) && !std::binary_search(list.begin(), list.end(), i)) ADD.push_back(i);
+			merge(list);
+			for (size_t k = 0; k < list.size(); ++ k) INDEX[0][list[k]] = k;
+
+			update<1>();
 		}
 
-		if (old_edge_state[i] == t_state::CROSS) {
+		//Вершины сечения: вершины подпространства и точки пересечения ребер:
+		const auto &old_vert = MESH.vert();
+		const auto &old_edge = MESH.template cell<1>();
+		std::vector<t_sliced_vert> new_vert;
+		new_vert.reserve(LIST[0].size() + LIST[1].size());
+		for (int i: LIST[0]) {
+			new_vert.push_back(basis.put(old_vert[i]));
+		}
+		for (int i: LIST[1]) {
+			if (STATE[1][i] != t_state::CROSS) continue;
+			const int a = old_edge[i][0], b = old_edge[i][1];
 			const auto &pa = old_vert[a], &pb = old_vert[b];
 			T p = - ((pa - center) * normal) /
 			        ((pb - pa) * normal);
-			//Add new vert:
-			new_edge_child[i].push_back(new_vert.size());
-			new_vert.push_back(
-			basis.put(pa + p * (pb - pa))
-			);
+			new_vert.push_back(basis.put(pa + p * (pb - pa)));
+		}
+
+		if (same) {
+			SECT = t_sliced_mesh(std::move(new_vert), SECT.share());
+			return SECT;
+		}
+
+		//Собираем ребра и ячейки сечения (сетка - часть результата, поэтому создается заново):
+		t_grid<L> new_grid;
+		auto &new_edge = new_grid.template cell<1>();
+		int v = LIST[0].size();
+		for (int i: LIST[1]) {
+			const int a = old_edge[i][0], b = old_edge[i][1];
+			auto &child = CHILD[1][i];
+			child.clear();
+			if (VERT_STATE[a] == 0) child.push_back(INDEX[0][a]);
+			if (VERT_STATE[b] == 0) child.push_back(INDEX[0][b]);
+			if (STATE[1][i] == t_state::CROSS) {
+				child.push_back(v ++);
+			}
+			if (STATE[1][i] == t_state::INNER) {
+				INDEX[1][i] = new_edge.size();
+				new_edge.push_back({t_index(INDEX[0][a]), t_index(INDEX[0][b])});
+			}
 		}
-		if (old_edge_state[i] == t_state::INNER) {
-			//Add new edge:
-			new_edge_index[i] = new_edge.size();
-			new_edge.push_back({
-			new_vert_index[a],
-			new_vert_index[b]
+		make<1>(new_grid);
+		fillLinks(new_grid, pool);
+
+		SECT = t_sliced_mesh(std::move(new_vert), std::move(new_grid));
+		FIRST = false;
+		return SECT;
+	}
+
+	const t_sliced_mesh &update(const t_basis<T, N, N - 1> &basis) {
+		TASK::t_pool pool(1);
+		return update(
+		basis, pool
+		);
+	}
+
+	//Последнее сечение:
+	const t_sliced_mesh &mesh() const {
+		return SECT;
+	}
+
+private:
+	template <unsigned K> void init() {
+		size_t num = MESH.vert().size();
+		if constexpr (K == 0) {
+			VERT_DIST.resize(num);
+			VERT_STATE.resize(num);
+		}
+		else {
+			num = MESH.template cell<K>().size();
+		}
+		STATE[K].resize(num);
+		FLAG[K].resize(num);
+		MARK[K].resize(num);
+		CHILD[K].resize(num);
+		INDEX[K].resize(num, nullind);
+		if constexpr (K < M) {
+			init<K + 1>();
+		}
+	}
+
+	//Слияние упорядоченного списка с упорядоченным списком ADD:
+	void merge(std::vector<int> &list) {
+		if (ADD.empty()) return;
+		TEMP.resize(list.size() + ADD.size());
+		std::merge(list.begin(), list.end(), ADD.begin(), ADD.end(), TEMP.begin());
+		list.swap(TEMP);
+	}
+
+	//Пересчитываем K-ячейки, содержащие подъячейки со сменившимся состоянием (CHANGE[K - 1]):
+	template <unsigned K> void update() {
+
+		const auto &old_cell = MESH.template cell<K>();
+		const auto &item = CHANGE[K - 1];
+		auto &dirty = DIRTY[K];
+		dirty.clear();
+		if (FIRST) {
+			dirty.resize(old_cell.size());
+			std::iota(dirty.begin(), dirty.end(), 0);
+		}
+		else {
+			const auto &link = MESH.template link<K - 1>();
+			for (int i: item) {
+				if (size_t(i) >= link.size()) continue;
+				for (int c: link[i]) if (!MARK[K][c]) { MARK[K][c] = 1; dirty.push_back(c); }
+			}
+			for (int c: dirty) MARK[K][c] = 0;
+			std::sort(dirty.begin(), dirty.end());
+		}
+
+		auto &changed = CHANGE[K];
+		changed.clear();
+		ADD.clear();
+		for (int c: dirty) {
+			t_state state; bool active;
+			if constexpr (K == 1) {
+				const int a = VERT_STATE[old_cell[c][0]], b = VERT_STATE[old_cell[c][1]];
+				state = getEdgeState(a, b);
+				active = (state == t_state::CROSS) || (a == 0) || (b == 0);
+			}
+			else {
+				size_t cross = 0, lower = 0, upper = 0, inner = 0;
+				for (int i: old_cell[c]) {
+					if (STATE[K - 1][i] == t_state::CROSS) { ++ cross; }
+					if (STATE[K - 1][i] == t_state::LOWER) { ++ lower; }
+					if (STATE[K - 1][i] == t_state::UPPER) { ++ upper; }
+					if (STATE[K - 1][i] == t_state::INNER) { ++ inner; }
+				}
+				if (inner == old_cell[c].size()) state = t_state::INNER;
+				else
+				if (cross || (upper && lower)) state = t_state::CROSS;
+				else {
+					state = lower? t_state::LOWER: t_state::UPPER;
+				}
+				active = (state == t_state::CROSS) || (inner > 0);
+			}
+			if (FIRST || (state != STATE[K][c])) changed.push_back(c);
+			if (active && !FLAG[K][c]) ADD.push_back(c);
+			STATE[K][c] = state;
+			FLAG[K][c] = active;
+		}
+
+		auto &list = LIST[K];
+		list.erase(std::remove_if(list.begin(), list.end(), [this](int c) { return !FLAG[K][c]; }), list.end());
+		merge(list);
+
+		if constexpr (K < M) {
+			update<K + 1>();
+		}
+	}
+
+	//Строим K-подъячейки из пересекаемых (K+1)-ячеек и (K+1)-ячейки подпространства:
+	template <unsigned K> void make(t_grid<L> &new_grid) {
+
+		if constexpr (K < M) {
+
+			const auto &old_cell = MESH.template cell<K + 1>();
+			auto &new_item = new_grid.template cell<K>();
+			const int base = new_item.size();
+			int count = 0;
+			auto &item = SCRATCH;
+
+			for (int c: LIST[K + 1]) {
+				auto &child = CHILD[K + 1][c];
+				child.clear();
+				for (int i: old_cell[c]) {
+					if (STATE[K][i] == t_state::INNER) child.push_back(INDEX[K][i]);
+				}
+				if (STATE[K + 1][c] != t_state::CROSS) continue;
+
+				item.clear();
+				for (int i: old_cell[c]) if (FLAG[K][i]) item.insert(CHILD[K][i].begin(), CHILD[K][i].end());
+				item.sort();
+
+				child.push_back(base + count ++);
+				pushItem<K>(new_item, item);
+			}
+
+			if constexpr (K < L) {
+				auto &new_cell = new_grid.template cell<K + 1>();
+				for (int c: LIST[K + 1]) {
+					if (STATE[K + 1][c] != t_state::INNER) continue;
+					item.clear();
+					for (int i: old_cell[c]) item.insert(INDEX[K][i]);
+					item.sort();
+					INDEX[K + 1][c] = new_cell.size();
+					new_cell.push_back(item);
+				}
+			}
+
+			make<K + 1>(new_grid);
+		}
+	}
+
+	t_section(const t_section &) = delete;
+
+	const t_mesh<T, N, M> MESH;
+	const T EPS;
+	t_sliced_mesh SECT;
+	bool FIRST = true;
+
+	std::vector<T> VERT_DIST;
+	std::vector<int> VERT_STATE;
+
+	//Данные уровней (0 - вершины): состояния, признаки и упорядоченные списки ячеек,
+	//пересекающих или касающихся подпространства, дочерние ячейки и новые номера:
+	std::array<std::vector<t_state>, M + 1> STATE;
+	std::array<std::vector<char>, M + 1> FLAG;
+	std::array<std::vector<char>, M + 1> MARK;
+	std::array<std::vector<int>, M + 1> LIST;
+	std::array<std::vector<t_child>, M + 1> CHILD;
+	std::array<std::vector<int>, M + 1> INDEX;
+
+	//Рабочие массивы, память которых сохраняется между вызовами: вершины со сменившимся
+	//знаком частей цикла, пересчитываемые и изменившиеся ячейки уровней, ячейки,
+	//добавляемые в упорядоченный список, буфер слияния и набор индексов подъячеек:
+	std::vector<std::vector<int>> PART;
+	std::array<std::vector<int>, M + 1> DIRTY;
+	std::array<std::vector<int>, M + 1> CHANGE;
+	std::vector<int> ADD;
+	std::vector<int> TEMP;
+	t_scratch SCRATCH;
+};
+
+//Распределение ячеек по набору параллельных гиперплоскостей: для каждой ячейки находится
+//диапазон расстояний её вершин, по нему - отрезок задеваемых гиперплоскостей (смещения
+//упорядочены), после чего для каждой гиперплоскости собирается упорядоченный список ячеек:
+template <typename T, unsigned M>
+struct t_sect_bands {
+
+	t_sect_bands(const t_grid<M> &grid, const std::vector<T> &dist, const std::vector<T> &offs, TASK::t_pool &pool,
+	             T eps = getEpsilon<T>()): EPS(eps) {
+		LOWER[0] = dist;
+		UPPER[0] = dist;
+		make<0>(grid, offs, pool);
+	}
+
+	//Упорядоченный список ячеек уровня K, задеваемых гиперплоскостью:
+	template <unsigned K> t_span<int> list(size_t slice) const {
+		return BAND[K][slice];
+	}
+	//Расстояние до вершины:
+	T dist(int i) const {
+		return LOWER[0][i];
+	}
+	//Лежит ли незадетая ячейка уровня K выше гиперплоскости:
+	template <unsigned K> bool upper(int i, T offs) const {
+		return LOWER[K][i] - offs >= EPS;
+	}
+
+	//Допуск, в пределах которого вершина лежит на гиперплоскости:
+	const T EPS;
+
+	//Диапазоны расстояний вершин ячеек:
+	std::array<std::vector<T>, M + 1> LOWER;
+	std::array<std::vector<T>, M + 1> UPPER;
+	//Ячейки, задеваемые каждой гиперплоскостью:
+	std::array<t_flat<int>, M + 1> BAND;
+
+private:
+	template <unsigned K> void make(const t_grid<M> &grid, const std::vector<T> &offs, TASK::t_pool &pool) {
+
+		if constexpr (K > 0) {
+			const auto &cell = grid.template cell<K>();
+			LOWER[K].resize(cell.size());
+			UPPER[K].resize(cell.size());
+			pool.run(cell.size(), [&](unsigned, size_t start, size_t end) {
+				for (size_t c = start; c < end; ++ c) {
+					T lower = std::numeric_limits<T>::max(), upper = std::numeric_limits<T>::lowest();
+					for (int i: cell[c]) {
+						lower = std::min(lower, LOWER[K - 1][i]);
+						upper = std::max(upper, UPPER[K - 1][i]);
+					}
+					LOWER[K][c] = lower;
+					UPPER[K][c] = upper;
+				}
 			});
 		}
+
+		//Ячейка задевается гиперплоскостью, если не лежит целиком выше или ниже неё:
+		const size_t num = LOWER[K].size();
+		std::vector<std::pair<int, int>> range(num);
+		pool.run(num, [&](unsigned, size_t start, size_t end) {
+			for (size_t c = start; c < end; ++ c) {
+				const T lower = LOWER[K][c], upper = UPPER[K][c];
+				range[c].first = std::partition_point(offs.begin(), offs.end(), [this, lower](T o) {
+					return lower - o >= EPS;
+				}) - offs.begin();
+				range[c].second = std::partition_point(offs.begin(), offs.end(), [this, upper](T o) {
+					return upper - o > - EPS;
+				}) - offs.begin();
+			}
+		});
+
+		std::vector<size_t> band_offs(offs.size() + 1, 0);
+		for (const auto &r: range) {
+			for (int k = r.first; k < r.second; ++ k) ++ band_offs[k + 1];
+		}
+		std::partial_sum(band_offs.begin(), band_offs.end(), band_offs.begin());
+		std::vector<int> band_item(band_offs.back());
+		std::vector<size_t> pos(band_offs.begin(), band_offs.end() - 1);
+		for (size_t c = 0; c < num; ++ c) {
+			for (int k = range[c].first; k < range[c].second; ++ k) band_item[pos[k] ++] = c;
+		}
+		BAND[K] = t_flat<int>(std::move(band_offs), std::move(band_item));
+
+		if constexpr (K < M) {
+			make<K + 1>(grid, offs, pool);
+		}
 	}
+};
 
-	//Вызываемся рекурсивно вверх:
-	constexpr unsigned L = t_sect_reduce<N, M>::dim;
-	t_sect_builder<M, L, 1, true>(old_grid, new_grid
-	).make(
-	old_edge_state, new_edge_child, new_edge_index
+//Сечение одной гиперплоскостью из набора: обходятся только задеваемые ею ячейки,
+//состояния остальных (целиком выше или ниже) определяются по диапазонам расстояний.
+//Порядок элементов результата совпадает с getSection.
+template <typename T, unsigned N, unsigned M, typename B = t_sect_bands<T, M>>
+struct t_sect_slice {
+
+	static constexpr unsigned L = t_sect_reduce<N, M>::dim;
+
+	typedef t_mesh<T, N - 1, L> t_sliced_mesh;
+	typedef typename t_sliced_mesh::t_vert t_sliced_vert;
+
+	t_sect_slice(const t_mesh<T, N, M> &_mesh, const B &_band, size_t _slice, T _offs):
+	             mesh(_mesh), band(_band), slice(_slice), offs(_offs) {}
+
+	t_sliced_mesh make(const t_basis<T, N, N - 1> &basis) {
+
+		t_basis<T, N, N> extBasis = basis.template ext<N>();
+		const auto &center = extBasis.center();
+		const auto &normal = extBasis[N - 1];
+
+		//Вершины, лежащие в подпространстве:
+		const auto &old_vert = mesh.vert();
+		const auto vert = band.template list<0>(slice);
+		std::vector<t_sliced_vert> new_vert;
+		new_vert.reserve(vert.size());
+		for (int i: vert) {
+			new_vert.push_back(basis.put(old_vert[i]));
+		}
+
+		//Разрезаем ребра подпространством:
+		const auto &old_edge = mesh.template cell<1>();
+		const auto edge = band.template list<1>(slice);
+		t_grid<L> new_grid;
+		auto &new_edge = new_grid.template cell<1>();
+		STATE[1].resize(edge.size());
+		CHILD[1].resize(edge.size());
+		INDEX[1].resize(edge.size(), nullind);
+
+		for (size_t j = 0; j < edge.size(); ++ j) {
+
+			const int a = old_edge[edge[j]][0], b = old_edge[edge[j]][1];
+			const int sa = getState(a), sb = getState(b);
+
+			if (sa == 0) CHILD[1][j].push_back(find<0>(a));
+			if (sb == 0) CHILD[1][j].push_back(find<0>(b));
+			STATE[1][j] = getEdgeState(sa, sb);
+
+			if (STATE[1][j] == t_state::CROSS) {
+				const auto &pa = old_vert[a], &pb = old_vert[b];
+				T p = - ((pa - center) * normal) /
+				        ((pb - pa) * normal);
+				CHILD[1][j].push_back(new_vert.size());
+				new_vert.push_back(basis.put(pa + p * (pb - pa)));
+			}
+			if (STATE[1][j] == t_state::INNER) {
+				INDEX[1][j] = new_edge.size();
+				new_edge.push_back({t_index(find<0>(a)), t_index(find<0>(b))});
+			}
+		}
+
+		//Вызываемся рекурсивно вверх:
+		make<1>(new_grid);
+		TASK::t_pool pool(1);
+		fillLinks(new_grid, pool);
+
+		return t_sliced_mesh(
+		std::move(new_vert),
+		std::move(new_grid)
+		);
+	}
+
+private:
+	int getState(int i) const {
+		const T p = band.dist(i) - offs;
+		return int(p >= band.EPS) - int(p <= - band.EPS);
+	}
+
+	//Номер ячейки в списке задеваемых ячеек уровня:
+	template <unsigned K> int find(int c) const {
+		const auto list = band.template list<K>(slice);
+		auto iter = std::lower_bound(list.begin(), list.end(), c);
+		return ((iter != list.end()) && (*iter == c))? int(iter - list.begin()): nullind;
+	}
+
+	template <unsigned K> void make(t_grid<L> &new_grid) {
+
+		if constexpr (K < M) {
+
+			const auto &old_cell = mesh.template cell<K + 1>();
+			const auto cell = band.template list<K + 1>(slice);
+			auto &new_item = new_grid.template cell<K>();
+			STATE[K + 1].resize(cell.size());
+			CHILD[K + 1].resize(cell.size());
+			INDEX[K + 1].resize(cell.size(), nullind);
+			t_scratch item;
+
+			for (size_t j = 0; j < cell.size(); ++ j) {
+
+				//Проверяем положение ячейки относительно подпространства:
+				size_t cross = 0, lower = 0, upper = 0, inner = 0;
+				for (int i: old_cell[cell[j]]) {
+					const int k = find<K>(i);
+					const t_state state = (k != nullind)? STATE[K][k]:
+					                      band.template upper<K>(i, offs)? t_state::UPPER: t_state::LOWER;
+					if (state == t_state::CROSS) { ++ cross; }
+					if (state == t_state::LOWER) { ++ lower; }
+					if (state == t_state::UPPER) { ++ upper; }
+					if (state == t_state::INNER) {
+						CHILD[K + 1][j].push_back(INDEX[K][k]);
+						++ inner;
+					}
+				}
+				auto &state = STATE[K + 1][j];
+				if (inner == old_cell[cell[j]].size()) state = t_state::INNER;
+				else
+				if (cross || (upper && lower)) state = t_state::CROSS;
+				else {
+					state = lower? t_state::LOWER: t_state::UPPER;
+				}
+
+				if (state != t_state::CROSS) continue;
+
+				//Добавляем новую подъячейку:
+				item.clear();
+				for (int i: old_cell[cell[j]]) {
+					const int k = find<K>(i); if (k != nullind) item.insert(CHILD[K][k].begin(), CHILD[K][k].end());
+				}
+				item.sort();
+
+				CHILD[K + 1][j].push_back(new_item.size());
+				pushItem<K>(new_item, item);
+			}
+
+			if constexpr (K < L) {
+				auto &new_cell = new_grid.template cell<K + 1>();
+				for (size_t j = 0; j < cell.size(); ++ j) {
+					if (STATE[K + 1][j] != t_state::INNER) continue;
+					item.clear();
+					for (int i: old_cell[cell[j]]) item.insert(INDEX[K][find<K>(i)]);
+					item.sort();
+					INDEX[K + 1][j] = new_cell.size();
+					new_cell.push_back(item);
+				}
+			}
+
+			make<K + 1>(new_grid);
+		}
+	}
+
+	const t_mesh<T, N, M> &mesh;
+	const B &band;
+	const size_t slice;
+	const T offs;
+
+	//Данные задеваемых ячеек уровней (в порядке списков band.list):
+	std::array<std::vector<t_state>, M + 1> STATE;
+	std::array<std::vector<t_child>, M + 1> CHILD;
+	std::array<std::vector<int>, M + 1> INDEX;
+};
+
+//Метод сечения набором параллельных гиперплоскостей, смещенных от basis вдоль нормали
+//на упорядоченные по возрастанию offs. Расстояния до вершин считаются однажды, каждое
+//сечение обходит только задеваемые им ячейки, сечения строятся параллельно
+//(eps - допуск, в пределах которого вершина лежит на гиперплоскости):
+template <typename T, unsigned N,
+                      unsigned M>
+auto getSections(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis, const std::vector<T> &offs,
+                 TASK::t_pool &pool,
+                 typename std::common_type<T>::type eps = getEpsilon<T>()) {
+
+	typedef t_mesh<T, N - 1, t_sect_reduce<N, M>::dim> t_sliced_mesh;
+
+	assert(std::is_sorted(offs.begin(), offs.end()));
+
+	t_basis<T, N, N> extBasis = basis.template ext<N>();
+	const auto &center = extBasis.center();
+	const auto &normal = extBasis[N - 1];
+
+	std::vector<T> dist(mesh.vert().size());
+	pool.run(dist.size(), [&](unsigned, size_t start, size_t end) {
+		mesh.dot(center, normal, dist.data(), start, end);
+	});
+
+	const t_sect_bands<T, M> band(mesh.grid(), dist, offs, pool, eps);
+
+	std::vector<t_sliced_mesh> sect(offs.size());
+	pool.each(offs.size(), [&](size_t k) {
+		sect[k] = t_sect_slice<T, N, M>(mesh, band, k, offs[k]).make(basis.mov(offs[k] * normal));
+	});
+	return sect;
+}
+
+template <typename T, unsigned N,
+                      unsigned M>
+auto getSections(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis, const std::vector<T> &offs) {
+	TASK::t_pool pool(1);
+	return getSections(
+	mesh, basis, offs, pool
 	);
+}
 
-	return t_sliced_mesh(
-	std::move(new_vert),
-	new_grid
+//Ячейки, задеваемые одной гиперплоскостью, среди ячеек, найденных по иерархии ограничивающих
+//параллелепипедов: старшие ячейки берутся из mesh.bvh(), их подъячейки и вершины - по сетке,
+//расстояния считаются только до вершин найденных ячеек. Ячейки, не входящие ни в одну
+//старшую ячейку, не рассматриваются.
+template <typename T, unsigned N, unsigned M>
+struct t_sect_cull {
+
+	t_sect_cull(const t_mesh<T, N, M> &_mesh, const t_vector<T, N> &center,
+	                                          const t_vector<T, N> &normal,
+	            TASK::t_pool &pool,
+	            T eps = getEpsilon<T>()): EPS(eps), mesh(_mesh) {
+
+		const auto top = mesh.bvh(pool).find(center, normal, EPS);
+		ITEM[M].assign(top.begin(), top.end());
+		std::sort(ITEM[M].begin(), ITEM[M].end());
+		item<M>();
+
+		std::vector<T> dist(ITEM[0].size());
+		pool.run(dist.size(), [&](unsigned, size_t start, size_t end) {
+			mesh.dot(center, normal, ITEM[0].data() + start, dist.data() + start, end - start);
+		});
+		for (size_t j = 0; j < dist.size(); ++ j) {
+			const T p = dist[j];
+			RANGE[0].push_back({p, p});
+			if ((p < EPS) && (p > - EPS)) LIST[0].push_back(ITEM[0][j]);
+		}
+		make<1>();
+	}
+
+	template <unsigned K> t_span<int> list(size_t) const {
+		return t_span<int>(LIST[K].data(), LIST[K].size());
+	}
+	T dist(int i) const {
+		return RANGE[0][find<0>(i)].first;
+	}
+	//Незадетая ячейка лежит целиком по одну сторону, поэтому достаточно одной её вершины:
+	template <unsigned K> bool upper(int i, T offs) const {
+		if constexpr (K > 0) {
+			return upper<K - 1>(mesh.template cell<K>()[i][0], offs);
+		}
+		else {
+			return dist(i) - offs >= EPS;
+		}
+	}
+
+	//Допуск, в пределах которого вершина лежит на гиперплоскости:
+	const T EPS;
+
+private:
+	template <unsigned K> int find(int c) const {
+		return std::lower_bound(ITEM[K].begin(), ITEM[K].end(), c) - ITEM[K].begin();
+	}
+
+	//Подъячейки найденных ячеек:
+	template <unsigned K> void item() {
+		if constexpr (K > 0) {
+			const auto &cell = mesh.template cell<K>();
+			for (int c: ITEM[K]) {
+				ITEM[K - 1].insert(ITEM[K - 1].end(), cell[c].begin(), cell[c].end());
+			}
+			std::sort(ITEM[K - 1].begin(), ITEM[K - 1].end());
+			ITEM[K - 1].erase(std::unique(ITEM[K - 1].begin(), ITEM[K - 1].end()), ITEM[K - 1].end());
+			item<K - 1>();
+		}
+	}
+
+	//Диапазоны расстояний найденных ячеек и задеваемые ячейки:
+	template <unsigned K> void make() {
+		const auto &cell = mesh.template cell<K>();
+		for (size_t j = 0; j < ITEM[K].size(); ++ j) {
+			T lower = std::numeric_limits<T>::max(), upper = std::numeric_limits<T>::lowest();
+			for (int i: cell[ITEM[K][j]]) {
+				const auto &range = RANGE[K - 1][find<K - 1>(i)];
+				lower = std::min(lower, range.first);
+				upper = std::max(upper, range.second);
+			}
+			RANGE[K].push_back({lower, upper});
+			if (!(lower >= EPS) && !(upper <= - EPS)) LIST[K].push_back(ITEM[K][j]);
+		}
+		if constexpr (K < M) {
+			make<K + 1>();
+		}
+	}
+
+	const t_mesh<T, N, M> &mesh;
+
+	//Найденные ячейки уровней (упорядочены), диапазоны расстояний их вершин
+	//и задеваемые ячейки:
+	std::array<std::vector<int>, M + 1> ITEM;
+	std::array<std::vector<std::pair<T, T>>, M + 1> RANGE;
+	std::array<std::vector<int>, M + 1> LIST;
+};
+
+//Метод сечения гиперплоскостью с отбором ячеек по иерархии ограничивающих параллелепипедов
+//(mesh.bvh() строится при первом вызове и сохраняется вместе с сеткой): обходятся только
+//ячейки, параллелепипеды которых задевают гиперплоскость. Ячейки, не входящие ни в одну
+//старшую ячейку, пропускаются, поэтому результат совпадает с getSection только для сеток,
+//все ячейки которых принадлежат старшим ячейкам (как в сетках, построенных по старшим ячейкам).
+//eps - допуск, как и в getSections:
+template <typename T, unsigned N,
+                      unsigned M>
+auto getCulledSection(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis, TASK::t_pool &pool,
+                      typename std::common_type<T>::type eps = getEpsilon<T>()) {
+
+	t_basis<T, N, N> extBasis = basis.template ext<N>();
+	const t_sect_cull<T, N, M> band(
+	mesh, extBasis.center(), extBasis[N - 1], pool, eps
+	);
+	return t_sect_slice<T, N, M, t_sect_cull<T, N, M>>(mesh, band, 0, T(0)).make(basis);
+}
+
+template <typename T, unsigned N,
+                      unsigned M>
+auto getCulledSection(const t_mesh<T, N, M> &mesh, const t_basis<T, N, N - 1> &basis) {
+	TASK::t_pool pool(1);
+	return getCulledSection(
+	mesh, basis, pool
 	);
 }
 
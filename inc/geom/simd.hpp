@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2019-2020 Andrey Baranov <armath123@gmail.com>
+ *
+ * This file is part of MDGeom (Multi-Dimensional Geometry).
+ *
+ * MDGeom is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * MDGeom is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with MDGeom;
+ * if not, see <http://www.gnu.org/licenses/>
+**/
+
+#pragma once
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace GEOM {
+
+//Содержит вычислительные ядра для векторов малой размерности
+namespace SIMD {
+
+//NOTE: Sums in dot products are accumulated in the same order as std::inner_product does,
+//so the vectorized kernels give bitwise the same results as the scalar ones. For the same
+//reason products and sums are never fused (FMA), and AVX2 gives nothing over AVX here
+//(it adds integer lanes only). Rotation stays scalar for all sizes: it changes two
+//arbitrary coordinates i and j, and gathering them into one register costs more
+//than the four products themselves.
+
+//Scalar fallback:
+template <typename T, unsigned N> struct t_kernel {
+
+	static inline void add(T *ans, const T *lhs, const T *rhs) { for (int i = 0; i < N; ++ i) ans[i] = lhs[i] + rhs[i]; }
+	static inline void sub(T *ans, const T *lhs, const T *rhs) { for (int i = 0; i < N; ++ i) ans[i] = lhs[i] - rhs[i]; }
+	static inline void mul(T *ans, const T *lhs, const T &val) { for (int i = 0; i < N; ++ i) ans[i] = lhs[i] * val; }
+
+	static inline T dot(const T *lhs, const T *rhs) {
+		T ans = T(0); for (int i = 0; i < N; ++ i) ans += lhs[i] * rhs[i];
+		return ans;
+	}
+
+	static inline void rot(T *ans, int i, int j, const T &c, const T &s) {
+		const T a = ans[i], b = ans[j];
+		ans[i] = c * a - s * b;
+		ans[j] = s * a + c * b;
+	}
+};
+
+#if defined(__SSE2__)
+
+template <> struct t_kernel<double, 2>: t_kernel<double, 0> {
+
+	static inline void add(double *ans, const double *lhs, const double *rhs) {
+		_mm_storeu_pd(ans, _mm_add_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+	}
+	static inline void sub(double *ans, const double *lhs, const double *rhs) {
+		_mm_storeu_pd(ans, _mm_sub_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+	}
+	static inline void mul(double *ans, const double *lhs, const double &val) {
+		_mm_storeu_pd(ans, _mm_mul_pd(_mm_loadu_pd(lhs), _mm_set1_pd(val)));
+	}
+
+	static inline double dot(const double *lhs, const double *rhs) {
+		const __m128d p = _mm_mul_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs));
+		return _mm_cvtsd_f64(p) + _mm_cvtsd_f64(_mm_unpackhi_pd(p, p));
+	}
+};
+
+template <> struct t_kernel<double, 3>: t_kernel<double, 0> {
+
+	static inline void add(double *ans, const double *lhs, const double *rhs) {
+		t_kernel<double, 2>::add(ans, lhs, rhs); ans[2] = lhs[2] + rhs[2];
+	}
+	static inline void sub(double *ans, const double *lhs, const double *rhs) {
+		t_kernel<double, 2>::sub(ans, lhs, rhs); ans[2] = lhs[2] - rhs[2];
+	}
+	static inline void mul(double *ans, const double *lhs, const double &val) {
+		t_kernel<double, 2>::mul(ans, lhs, val); ans[2] = lhs[2] * val;
+	}
+
+	static inline double dot(const double *lhs, const double *rhs) {
+		return t_kernel<double, 2>::dot(lhs, rhs) + lhs[2] * rhs[2];
+	}
+};
+
+template <> struct t_kernel<double, 4>: t_kernel<double, 0> {
+
+#if defined(__AVX__)
+	static inline void add(double *ans, const double *lhs, const double *rhs) {
+		_mm256_storeu_pd(ans, _mm256_add_pd(_mm256_loadu_pd(lhs), _mm256_loadu_pd(rhs)));
+	}
+	static inline void sub(double *ans, const double *lhs, const double *rhs) {
+		_mm256_storeu_pd(ans, _mm256_sub_pd(_mm256_loadu_pd(lhs), _mm256_loadu_pd(rhs)));
+	}
+	static inline void mul(double *ans, const double *lhs, const double &val) {
+		_mm256_storeu_pd(ans, _mm256_mul_pd(_mm256_loadu_pd(lhs), _mm256_set1_pd(val)));
+	}
+
+	static inline double dot(const double *lhs, const double *rhs) {
+		const __m256d p = _mm256_mul_pd(_mm256_loadu_pd(lhs), _mm256_loadu_pd(rhs));
+		const __m128d a = _mm256_castpd256_pd128(p);
+		const __m128d b = _mm256_extractf128_pd(p, 1);
+		return ((_mm_cvtsd_f64(a) + _mm_cvtsd_f64(_mm_unpackhi_pd(a, a))) +
+		         _mm_cvtsd_f64(b)) + _mm_cvtsd_f64(_mm_unpackhi_pd(b, b));
+	}
+#else
+	static inline void add(double *ans, const double *lhs, const double *rhs) {
+		t_kernel<double, 2>::add(ans, lhs, rhs); t_kernel<double, 2>::add(ans + 2, lhs + 2, rhs + 2);
+	}
+	static inline void sub(double *ans, const double *lhs, const double *rhs) {
+		t_kernel<double, 2>::sub(ans, lhs, rhs); t_kernel<double, 2>::sub(ans + 2, lhs + 2, rhs + 2);
+	}
+	static inline void mul(double *ans, const double *lhs, const double &val) {
+		t_kernel<double, 2>::mul(ans, lhs, val); t_kernel<double, 2>::mul(ans + 2, lhs + 2, val);
+	}
+
+	static inline double dot(const double *lhs, const double *rhs) {
+		const __m128d p = _mm_mul_pd(_mm_loadu_pd(lhs + 0), _mm_loadu_pd(rhs + 0));
+		const __m128d q = _mm_mul_pd(_mm_loadu_pd(lhs + 2), _mm_loadu_pd(rhs + 2));
+		return ((_mm_cvtsd_f64(p) + _mm_cvtsd_f64(_mm_unpackhi_pd(p, p))) +
+		         _mm_cvtsd_f64(q)) + _mm_cvtsd_f64(_mm_unpackhi_pd(q, q));
+	}
+#endif
+};
+
+template <> struct t_kernel<float, 4>: t_kernel<float, 0> {
+
+	static inline void add(float *ans, const float *lhs, const float *rhs) {
+		_mm_storeu_ps(ans, _mm_add_ps(_mm_loadu_ps(lhs), _mm_loadu_ps(rhs)));
+	}
+	static inline void sub(float *ans, const float *lhs, const float *rhs) {
+		_mm_storeu_ps(ans, _mm_sub_ps(_mm_loadu_ps(lhs), _mm_loadu_ps(rhs)));
+	}
+	static inline void mul(float *ans, const float *lhs, const float &val) {
+		_mm_storeu_ps(ans, _mm_mul_ps(_mm_loadu_ps(lhs), _mm_set1_ps(val)));
+	}
+
+	static inline float dot(const float *lhs, const float *rhs) {
+		alignas(16) float p[4];
+		_mm_store_ps(p, _mm_mul_ps(_mm_loadu_ps(lhs), _mm_loadu_ps(rhs)));
+		return ((p[0] + p[1]) + p[2]) + p[3];
+	}
+};
+
+//Pair of floats is loaded into low half of register:
+template <> struct t_kernel<float, 2>: t_kernel<float, 0> {
+
+	static inline __m128 load(const float *src) {
+		return _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(src));
+	}
+	static inline void store(float *dst, __m128 val) {
+		_mm_storel_pi(reinterpret_cast<__m64 *>(dst), val);
+	}
+
+	static inline void add(float *ans, const float *lhs, const float *rhs) {
+		store(ans, _mm_add_ps(load(lhs), load(rhs)));
+	}
+	static inline void sub(float *ans, const float *lhs, const float *rhs) {
+		store(ans, _mm_sub_ps(load(lhs), load(rhs)));
+	}
+	static inline void mul(float *ans, const float *lhs, const float &val) {
+		store(ans, _mm_mul_ps(load(lhs), _mm_set1_ps(val)));
+	}
+
+	static inline float dot(const float *lhs, const float *rhs) {
+		const __m128 p = _mm_mul_ps(load(lhs), load(rhs));
+		return _mm_cvtss_f32(p) + _mm_cvtss_f32(_mm_shuffle_ps(p, p, 1));
+	}
+};
+
+template <> struct t_kernel<float, 3>: t_kernel<float, 0> {
+
+	static inline void add(float *ans, const float *lhs, const float *rhs) {
+		t_kernel<float, 2>::add(ans, lhs, rhs); ans[2] = lhs[2] + rhs[2];
+	}
+	static inline void sub(float *ans, const float *lhs, const float *rhs) {
+		t_kernel<float, 2>::sub(ans, lhs, rhs); ans[2] = lhs[2] - rhs[2];
+	}
+	static inline void mul(float *ans, const float *lhs, const float &val) {
+		t_kernel<float, 2>::mul(ans, lhs, val); ans[2] = lhs[2] * val;
+	}
+
+	static inline float dot(const float *lhs, const float *rhs) {
+		return t_kernel<float, 2>::dot(lhs, rhs) + lhs[2] * rhs[2];
+	}
+};
+
+#endif
+
+//...
+
+}//SIMD
+
+}//GEOM
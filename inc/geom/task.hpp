@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2019-2020 Andrey Baranov <armath123@gmail.com>
+ *
+ * This file is part of MDGeom (Multi-Dimensional Geometry).
+ *
+ * MDGeom is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * MDGeom is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with MDGeom;
+ * if not, see <http://www.gnu.org/licenses/>
+**/
+
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <exception>
+#include <cassert>
+#include <vector>
+#include <thread>
+#include <mutex>
+
+namespace GEOM {
+
+//Содержит пул потоков для разбиения циклов на непрерывные части
+namespace TASK {
+
+//NOTE: Range [0, num) is always split into the same contiguous parts for the same num,
+//so callers can count outputs per part in one pass and write them at prefix offsets in another.
+//Pool serves one caller at a time and is not reentrant: run and each must not be called
+//from several threads at once or from inside a task of the same pool (use separate pools).
+//Exception thrown by a task is rethrown by the caller after all parts are finished.
+struct t_pool {
+
+	explicit t_pool(unsigned _size = std::thread::hardware_concurrency(), size_t _grain = 4096):
+	                SIZE(std::max(_size, 1u)), GRAIN(std::max<size_t>(_grain, 1)) {
+		for (unsigned k = 1; k < SIZE; ++ k) {
+			WORK.emplace_back([this, k]() { loop(k); });
+		}
+	}
+
+	~t_pool() {
+		{
+		std::lock_guard<std::mutex> lock(LOCK);
+		STOP = true;
+		}
+		WAKE.notify_all();
+		for (auto &work: WORK) work.join();
+	}
+
+	//Number of parts the range of given length is split into:
+	unsigned part(size_t num) const {
+		return (num >= 2 * GRAIN)? std::min<size_t>(SIZE, num / GRAIN): 1;
+	}
+
+	//Calls func(part, start, end) for every part of range [0, num) and waits for all of them:
+	template <typename F> void run(size_t num, const F &func) {
+
+		const unsigned count = part(num);
+		if (count == 1) {
+			func(0u, size_t(0), num);
+			return;
+		}
+		call(count, [&](unsigned k) {
+			func(k, num * k / count, num * (k + 1) / count);
+		});
+	}
+
+	//Calls func(i) for every independent task i of [0, num) regardless of the grain:
+	template <typename F> void each(size_t num, const F &func) {
+
+		const unsigned count = std::min<size_t>(SIZE, num);
+		if (count <= 1) {
+			for (size_t i = 0; i < num; ++ i) func(i);
+			return;
+		}
+		call(count, [&](unsigned k) {
+			for (size_t i = k; i < num; i += count) func(i);
+		});
+	}
+
+	unsigned size() const {
+		return SIZE;
+	}
+
+private:
+	t_pool(const t_pool &) = delete;
+
+	//Calls func(k) on thread k for every k of [0, count):
+	template <typename F> void call(unsigned count, const F &func) {
+
+		auto task = [&](unsigned k) {
+			if (k < count) func(k);
+		};
+		{
+		std::lock_guard<std::mutex> lock(LOCK);
+		assert(!TASK && "Pool is already running tasks!");
+		TASK = task;
+		LEFT = SIZE - 1;
+		++ STEP;
+		}
+		WAKE.notify_all();
+
+		//Workers use the task until all of them are done, so it must outlive them:
+		std::exception_ptr fail;
+		try {
+			task(0);
+		}
+		catch (...) {
+			fail = std::current_exception();
+		}
+
+		std::unique_lock<std::mutex> lock(LOCK);
+		DONE.wait(lock, [this]() { return LEFT == 0; });
+		TASK = nullptr;
+		if (!fail) fail = FAIL;
+		FAIL = nullptr;
+		if (fail) {
+			lock.unlock();
+			std::rethrow_exception(fail);
+		}
+	}
+
+	void loop(unsigned k) {
+
+		size_t step = 0;
+		for (;;) {
+			std::function<void(unsigned)> task;
+			{
+			std::unique_lock<std::mutex> lock(LOCK);
+			WAKE.wait(lock, [&]() { return STOP || (STEP != step); });
+			if (STOP) return;
+			step = STEP;
+			task = TASK;
+			}
+			std::exception_ptr fail;
+			try {
+				task(k);
+			}
+			catch (...) {
+				fail = std::current_exception();
+			}
+			{
+			std::lock_guard<std::mutex> lock(LOCK);
+			if (fail && !FAIL) FAIL = fail;
+			if (-- LEFT == 0) DONE.notify_all();
+			}
+		}
+	}
+
+	std::vector<std::thread> WORK;
+	std::function<void(unsigned)> TASK;
+	std::exception_ptr FAIL;
+	std::condition_variable WAKE;
+	std::condition_variable DONE;
+	std::mutex LOCK;
+	size_t STEP = 0;
+	unsigned LEFT = 0;
+	bool STOP = false;
+
+	const unsigned SIZE;
+	const size_t GRAIN;
+};
+
+//...
+
+}//TASK
+
+}//GEOM
@@ -36,7 +36,7 @@ template <unsigned N> bool checkDuplicate(const t_grid<N> &grid);
 template <> bool checkDuplicate(const t_grid<1> &grid);
 
 template <typename T, unsigned N, unsigned M>
-bool checkDuplicate(const t_mesh<T, N, M> &mesh, double eps = MATH_EPSILON) {
+bool checkDuplicate(const t_mesh<T, N, M> &mesh, double eps = getEpsilon<T>()) {
 
 	const auto &tree = mesh.tree();
 	for (auto &vert: mesh.vert())
@@ -49,10 +49,10 @@ bool checkDuplicate(const t_mesh<T, N, M> &mesh, double eps = MATH_EPSILON) {
 }
 
 template <unsigned N>
-bool checkDuplicate(const std::vector<t_cell<N>> &cell_list) {
+bool checkDuplicate(const t_list<N> &cell_list) {
 
 	std::set<std::set<int>> cell_set;
-	for (auto &cell: cell_list) {
+	for (const auto &cell: cell_list) {
 		std::set<int> item_set;
 		for (int item: cell) {
 		    if (item_set.count(item)) { return false; }
@@ -92,7 +92,7 @@ template <> bool checkEqual(const t_grid<1> &grid1, const std::map<size_t, size_
                             std::map<size_t, size_t> &cellMap2);
 
 template <typename T, unsigned N, unsigned M>
-bool checkEqual(const t_mesh<T, N, M> &mesh1, const t_mesh<T, N, M> &mesh2, double eps = MATH_EPSILON) {
+bool checkEqual(const t_mesh<T, N, M> &mesh1, const t_mesh<T, N, M> &mesh2, double eps = getEpsilon<T>()) {
 
 	std::map<size_t, size_t> vertMap1;
 	std::map<size_t, size_t> vertMap2;
@@ -136,9 +136,9 @@ bool checkEqual(const t_mesh<T, N, M> &mesh1, const t_mesh<T, N, M> &mesh2, doub
 }
 
 template <unsigned N>
-bool checkEqual(const std::vector<t_cell<N>> &cellList1, const std::map<size_t, size_t> &itemMap1,
+bool checkEqual(const t_list<N> &cellList1, const std::map<size_t, size_t> &itemMap1,
                 std::map<size_t, size_t> &cellMap1,
-                const std::vector<t_cell<N>> &cellList2, const std::map<size_t, size_t> &itemMap2,
+                const t_list<N> &cellList2, const std::map<size_t, size_t> &itemMap2,
                 std::map<size_t, size_t> &cellMap2) {
 
 	std::map<std::set<size_t>, size_t> cellInd;
@@ -20,7 +20,10 @@
 
 #pragma once
 #include "base.hpp"
+#include "task.hpp"
 #include <algorithm>
+#include <limits>
+#include <queue>
 #include <vector>
 #include <array>
 #include <memory>
@@ -32,72 +35,424 @@ using namespace BASE;
 //Содержит реализацию сортирующего двоичного дерева (KD-Tree)
 namespace TREE {
 
+//Split of range of points: SPLIT_EXACT chooses the axis by the spread of all points and selects the median
+//over the whole range; SPLIT_SAMPLE chooses the axis by a strided sample, partitions the range by the median
+//of the sample and selects the median only in the part containing it. The split is always at the middle
+//of the range (ranges of nodes are not stored), so both give valid trees of the same shape:
+enum t_split { SPLIT_EXACT, SPLIT_SAMPLE };
+
+//NOTE: Nodes are stored in one array in heap order (children of node k are 2k+1 and 2k+2),
+//every node splits its range of points at the middle, so ranges are not stored at all;
+//ranges of at most BUCKET points are leaves and are scanned linearly.
 template<typename T, unsigned N> struct t_tree {
 
 	typedef BASE::t_vector<T, N> t_vert;
 	typedef BASE::t_rect<T, N> t_rect;
 
-	std::vector<ptrdiff_t> find(const t_rect &_rect) const { std::vector<ptrdiff_t> LIST; find(LIST, ROOT.get(), _rect, 0); return LIST; }
+	static constexpr size_t BUCKET = 8;
+	static constexpr size_t SAMPLE = 64;
+	//Subtrees of less points are not forked to the pool:
+	static constexpr size_t SUBTREE = 8192;
+
+	std::vector<ptrdiff_t> find(const t_rect &_rect) const { std::vector<ptrdiff_t> LIST; find(LIST, _rect); return LIST; }
+
+	//Returns indices of (at most) k nearest points ordered by distance:
+	std::vector<ptrdiff_t> nearest(const t_vert &_vert, size_t _num) const {
+		std::vector<ptrdiff_t> LIST; nearest(LIST, _vert, _num); return LIST;
+	}
+
+	//Returns indices of points within given distance:
+	std::vector<ptrdiff_t> within(const t_vert &_vert, T _dist) const {
+		std::vector<ptrdiff_t> LIST; within(LIST, _vert, _dist); return LIST;
+	}
+
+	std::vector<std::vector<ptrdiff_t>> nearest(const std::vector<t_vert> &_vert, size_t _num, TASK::t_pool &_pool) const {
+		std::vector<std::vector<ptrdiff_t>> LIST(_vert.size());
+		_pool.run(_vert.size(), [&](unsigned, size_t start, size_t end) {
+			for (size_t i = start; i < end; ++ i) nearest(LIST[i], _vert[i], _num);
+		});
+		return LIST;
+	}
+
+	std::vector<std::vector<ptrdiff_t>> within(const std::vector<t_vert> &_vert, T _dist, TASK::t_pool &_pool) const {
+		std::vector<std::vector<ptrdiff_t>> LIST(_vert.size());
+		_pool.run(_vert.size(), [&](unsigned, size_t start, size_t end) {
+			for (size_t i = start; i < end; ++ i) within(LIST[i], _vert[i], _dist);
+		});
+		return LIST;
+	}
+
+	std::vector<std::vector<ptrdiff_t>> nearest(const std::vector<t_vert> &_vert, size_t _num) const {
+		TASK::t_pool pool(1); return nearest(_vert, _num, pool);
+	}
+
+	std::vector<std::vector<ptrdiff_t>> within(const std::vector<t_vert> &_vert, T _dist) const {
+		TASK::t_pool pool(1); return within(_vert, _dist, pool);
+	}
+
+	//Points are copied, so the source array is not used after construction:
+	explicit t_tree(const t_vert *_vert, size_t _num, t_split _split = SPLIT_EXACT): SPLIT(_split) {
+		TASK::t_pool pool(1); build(_vert, _num, pool);
+	}
 
-	explicit t_tree(const t_vert *_vert, size_t _num): VERT(_vert), ROOT(build(const_cast<t_vert *> (_vert), _num)) {}
+	explicit t_tree(const t_vert *_vert, size_t _num, TASK::t_pool &_pool, t_split _split = SPLIT_EXACT):
+	                SPLIT(_split) {
+		build(_vert, _num, _pool);
+	}
+
+	size_t size() const {
+		return INDEX.size();
+	}
 
 private:
 	struct t_node {
-		explicit t_node(t_node *p1, t_node *p2, const t_vert *v): NODE{p1, p2}, VERT{v} {}
-
-		~t_node() { for (auto &p: NODE) delete p; }
+		T SPLIT;
+		unsigned AXIS;
+	};
 
-		std::array<t_node*, 2> NODE;
-		const t_vert *VERT;
+	struct t_step {
+		size_t NODE, START, END;
 	};
 
-	void find(std::vector<ptrdiff_t> &list, t_node *node, const t_rect &rect, int step) const {
+	typedef std::array<t_step, 64> t_stack;
+
+	//Candidate (squared distance, index), the worst one is on top of the queue:
+	typedef std::pair<T, ptrdiff_t> t_item;
+
+	void nearest(std::vector<ptrdiff_t> &list, const t_vert &vert, size_t num) const {
+
+		if (INDEX.empty() || (num == 0)) return;
+
+		std::priority_queue<t_item> heap;
+		//Lower bound of squared distance to the range is kept for every step:
+		std::array<std::pair<t_step, T>, 64> stack; int top = 0;
+		stack[top ++] = {t_step{0, 0, INDEX.size()}, T(0)};
+		while (top > 0) {
+			const auto [step, dist] = stack[-- top];
+			if ((heap.size() == num) && (dist > heap.top().first)) {
+				continue;
+			}
+			if (step.END - step.START <= BUCKET) {
+				for (size_t i = step.START; i < step.END; ++ i) {
+					const t_vert diff = POINT[i] - vert;
+					const t_item item{diff * diff, INDEX[i]};
+					if (heap.size() < num) {
+						heap.push(item);
+					}
+					else if (item < heap.top()) {
+						heap.pop(); heap.push(item);
+					}
+				}
+				continue;
+			}
+			const t_node &node = NODE[step.NODE];
+			const size_t pivot = step.START + (step.END - step.START) / 2;
+			const T diff = vert[node.AXIS] - node.SPLIT;
+			const t_step left{2 * step.NODE + 1, step.START, pivot};
+			const t_step right{2 * step.NODE + 2, pivot, step.END};
+			//The nearer half is pushed last to be visited first:
+			if (diff < 0) {
+				stack[top ++] = {right, std::max(dist, diff * diff)};
+				stack[top ++] = {left, dist};
+			}
+			else {
+				stack[top ++] = {left, std::max(dist, diff * diff)};
+				stack[top ++] = {right, dist};
+			}
+		}
+
+		list.resize(heap.size());
+		for (size_t i = heap.size(); i > 0; -- i) {
+			list[i - 1] = heap.top().second; heap.pop();
+		}
+	}
+
+	void within(std::vector<ptrdiff_t> &list, const t_vert &vert, T dist) const {
+		walk(t_rect{vert - dist, vert + dist}, [&](size_t i) {
+			const t_vert diff = POINT[i] - vert;
+			if (diff * diff <= dist * dist) list.push_back(INDEX[i]);
+		});
+	}
+
+	void find(std::vector<ptrdiff_t> &list, const t_rect &rect) const {
+		walk(rect, [&](size_t i) {
+			if (inside(POINT[i], rect)) list.push_back(INDEX[i]);
+		});
+	}
+
+	//Calls func(i) for every point of the leaves intersecting the rectangle:
+	template <typename F> void walk(const t_rect &rect, const F &func) const {
+
+		if (INDEX.empty()) return;
 
-		if (node) {
-			const auto *vert = (node->VERT); size_t next = ((step < N - 1)? (step + 1): 0);
-			std::array<unsigned, N> test;
-			for (int i = 0; i < N; ++ i) {
-				test[i] = ((*vert)[i] >= rect.min[i]) | (((*vert)[i] <= rect.max[i]) << 1);
+		t_stack stack; int top = 0;
+		stack[top ++] = t_step{0, 0, INDEX.size()};
+		while (top > 0) {
+			const t_step step = stack[-- top];
+			if (step.END - step.START <= BUCKET) {
+				for (size_t i = step.START; i < step.END; ++ i) func(i);
+				continue;
 			}
-			if (std::count(test.begin(), test.end(), 3) == N) list.push_back(vert - VERT);
-			if (test[step] & 2) {
-				find(list, node->NODE[1], rect, next);
+			const t_node &node = NODE[step.NODE];
+			const size_t pivot = step.START + (step.END - step.START) / 2;
+			if (rect.max[node.AXIS] >= node.SPLIT) {
+				stack[top ++] = t_step{2 * step.NODE + 2, pivot, step.END};
 			}
-			if (test[step] & 1) {
-				find(list, node->NODE[0], rect, next);
+			if (rect.min[node.AXIS] <= node.SPLIT) {
+				stack[top ++] = t_step{2 * step.NODE + 1, step.START, pivot};
 			}
 		}
 	}
 
-	t_node *build(t_vert **start, t_vert **end, int step) {
+	static bool inside(const t_vert &vert, const t_rect &rect) {
+		for (int i = 0; i < N; ++ i) {
+			if ((vert[i] < rect.min[i]) || (vert[i] > rect.max[i])) return false;
+		}
+		return true;
+	}
 
-		if (start >= end) { return nullptr; }
+	//Splits range by the axis of the largest spread, subtrees at the given depth are not built
+	//but collected to the list of tasks:
+	void build(const t_vert *vert, size_t node, size_t start, size_t end, size_t depth, std::vector<t_step> *task) {
 
-		t_vert **pivot = start + (end - start) / 2;
-		std::nth_element(
-		start, pivot, end, [step](auto *a, auto *b) { return (*a)[step] < (*b)[step]; });
+		if (end - start <= BUCKET) return;
+		if ((depth == 0) && task) {
+			task->push_back(t_step{node, start, end});
+			return;
+		}
 
-		int next = (step < N - 1)? (step + 1): 0;
+		const size_t stride = (SPLIT == SPLIT_SAMPLE)? std::max<size_t>((end - start) / SAMPLE, 1): 1;
+		t_vert min = vert[INDEX[start]], max = min;
+		for (size_t i = start + stride; i < end; i += stride) {
+			const t_vert &item = vert[INDEX[i]];
+			for (int k = 0; k < N; ++ k) {
+				min[k] = std::min(min[k], item[k]);
+				max[k] = std::max(max[k], item[k]);
+			}
+		}
+		unsigned axis = 0;
+		for (unsigned k = 1; k < N; ++ k) {
+			if (max[k] - min[k] > max[axis] - min[axis]) axis = k;
+		}
 
-		return new t_node(
-		build(start, pivot, next), build(pivot + 1, end, next), *pivot
-		);
+		const size_t pivot = start + (end - start) / 2;
+		auto less = [vert, axis](ptrdiff_t a, ptrdiff_t b) { return vert[a][axis] < vert[b][axis]; };
+		auto first = INDEX.begin() + start, last = INDEX.begin() + end;
+		if (stride > 1) {
+			//Points below the median of the sample precede the others, so the median of the range
+			//is selected only in one part (it is near the middle, so the part is about a half):
+			std::array<T, 2 * SAMPLE> sample; size_t num = 0;
+			for (size_t i = start; i < end; i += stride) sample[num ++] = vert[INDEX[i]][axis];
+			std::nth_element(sample.begin(), sample.begin() + num / 2, sample.begin() + num);
+			const T split = sample[num / 2];
+			const auto part = std::partition(first, last, [vert, axis, split](ptrdiff_t a) { return vert[a][axis] < split; });
+			if (part - INDEX.begin() > ptrdiff_t(pivot)) last = part; else first = part;
+		}
+		std::nth_element(first, INDEX.begin() + pivot, last, less);
+
+		NODE[node] = t_node{vert[INDEX[pivot]][axis], axis};
+
+		if (task && (end - start < 2 * SUBTREE)) {
+			task->push_back(t_step{2 * node + 1, start, pivot});
+			task->push_back(t_step{2 * node + 2, pivot, end});
+			return;
+		}
+		build(vert, 2 * node + 1, start, pivot, depth - 1, task);
+		build(vert, 2 * node + 2, pivot, end, depth - 1, task);
 	}
 
-	t_node *build(t_vert *start, size_t num) {
-		std::vector<t_vert *> TEMP(num);
-		for (int i = 0; i < num; ++ i) {
-			TEMP[i] = start + i;
+	void build(const t_vert *vert, size_t num, TASK::t_pool &pool) {
+
+		//Depth of the tree is defined by the largest (right) halves:
+		size_t depth = 0;
+		for (size_t m = num; m > BUCKET; m = (m + 1) / 2) ++ depth;
+		NODE.resize((size_t(1) << depth) - 1);
+
+		INDEX.resize(num);
+		for (size_t i = 0; i < num; ++ i) {
+			INDEX[i] = i;
 		}
-		return build(
-		TEMP.data(), TEMP.data() + num, 0
-		);
+
+		//Upper levels are built serially until there are enough subtrees for all threads:
+		if ((pool.size() > 1) && (num >= 2 * SUBTREE)) {
+			size_t fork = 0;
+			while ((size_t(1) << fork) < 4 * pool.size()) ++ fork;
+			std::vector<t_step> task;
+			build(vert, 0, 0, num, fork, &task);
+			pool.each(task.size(), [&](size_t i) {
+				build(vert, task[i].NODE, task[i].START, task[i].END, depth, nullptr);
+			});
+		}
+		else {
+			build(vert, 0, 0, num, depth, nullptr);
+		}
+
+		//Points are copied in leaf order to scan buckets contiguously:
+		POINT.resize(num);
+		pool.run(num, [&](unsigned, size_t start, size_t end) {
+			for (size_t i = start; i < end; ++ i) POINT[i] = vert[INDEX[i]];
+		});
 	}
 
 	t_tree(const t_tree &) = delete;
 
-	std::unique_ptr<t_node> ROOT;
-	const t_vert *VERT;
+	std::vector<t_node> NODE;
+	std::vector<ptrdiff_t> INDEX;
+	std::vector<t_vert> POINT;
+	const t_split SPLIT;
+};
+
+//NOTE: Boxes are ordered like points of t_tree (every range is split at the middle by the axis
+//of the largest spread of box centers), every node of the heap-ordered array keeps the bounding
+//box of its range, so the tree is walked down only through the nodes passing the test.
+template<typename T, unsigned N> struct t_bvh {
+
+	typedef BASE::t_vector<T, N> t_vert;
+	typedef BASE::t_rect<T, N> t_rect;
+
+	static constexpr size_t BUCKET = 8;
+
+	//Returns indices of boxes intersecting the slab |(x - center) * normal| <= dist,
+	//boxes are tested with a small relative tolerance, so that no box touching the slab
+	//is missed because of rounding errors:
+	std::vector<ptrdiff_t> find(const t_vert &_center, const t_vert &_normal, T _dist) const {
+		std::vector<ptrdiff_t> LIST;
+		auto test = [&](const t_rect &rect) {
+			T dist = 0, size = 0, norm = 0;
+			for (int k = 0; k < N; ++ k) {
+				const T mid = (rect.min[k] + rect.max[k]) / 2;
+				const T rad = (rect.max[k] - rect.min[k]) / 2;
+				dist += (mid - _center[k]) * _normal[k];
+				size += rad * std::abs(_normal[k]);
+				norm += std::abs((mid - _center[k]) * _normal[k]);
+			}
+			const T slack = 8 * N * std::numeric_limits<T>::epsilon() * (norm + size);
+			return std::abs(dist) <= size + _dist + slack;
+		};
+		walk(test, [&](size_t i) {
+			if (test(RECT[i])) LIST.push_back(INDEX[i]);
+		});
+		return LIST;
+	}
+
+	//Returns indices of boxes intersecting the rectangle:
+	std::vector<ptrdiff_t> find(const t_rect &_rect) const {
+		std::vector<ptrdiff_t> LIST;
+		auto test = [&](const t_rect &rect) {
+			for (int k = 0; k < N; ++ k) {
+				if ((rect.max[k] < _rect.min[k]) || (rect.min[k] > _rect.max[k])) return false;
+			}
+			return true;
+		};
+		walk(test, [&](size_t i) {
+			if (test(RECT[i])) LIST.push_back(INDEX[i]);
+		});
+		return LIST;
+	}
+
+	explicit t_bvh(std::vector<t_rect> _rect): RECT(std::move(_rect)) {
+		build();
+	}
+
+	size_t size() const {
+		return INDEX.size();
+	}
+
+private:
+	struct t_step {
+		size_t NODE, START, END;
+	};
+
+	typedef std::array<t_step, 64> t_stack;
+
+	//Calls func(i) for every box of the leaves passing the test:
+	template <typename P, typename F> void walk(const P &test, const F &func) const {
+
+		if (INDEX.empty()) return;
+
+		t_stack stack; int top = 0;
+		stack[top ++] = t_step{0, 0, INDEX.size()};
+		while (top > 0) {
+			const t_step step = stack[-- top];
+			if (!test(NODE[step.NODE])) continue;
+			if (step.END - step.START <= BUCKET) {
+				for (size_t i = step.START; i < step.END; ++ i) func(i);
+				continue;
+			}
+			const size_t pivot = step.START + (step.END - step.START) / 2;
+			stack[top ++] = t_step{2 * step.NODE + 2, pivot, step.END};
+			stack[top ++] = t_step{2 * step.NODE + 1, step.START, pivot};
+		}
+	}
+
+	void build(size_t node, size_t start, size_t end, std::vector<t_rect> &rect) {
+
+		if (end - start <= BUCKET) {
+			t_rect box = rect[INDEX[start]];
+			for (size_t i = start + 1; i < end; ++ i) {
+				for (int k = 0; k < N; ++ k) {
+					box.min[k] = std::min(box.min[k], rect[INDEX[i]].min[k]);
+					box.max[k] = std::max(box.max[k], rect[INDEX[i]].max[k]);
+				}
+			}
+			NODE[node] = box;
+			return;
+		}
+
+		auto mid = [&rect](ptrdiff_t i, unsigned k) { return rect[i].min[k] + rect[i].max[k]; };
+		t_vert min, max;
+		for (int k = 0; k < N; ++ k) min[k] = max[k] = mid(INDEX[start], k);
+		for (size_t i = start + 1; i < end; ++ i) {
+			for (int k = 0; k < N; ++ k) {
+				min[k] = std::min(min[k], mid(INDEX[i], k));
+				max[k] = std::max(max[k], mid(INDEX[i], k));
+			}
+		}
+		unsigned axis = 0;
+		for (unsigned k = 1; k < N; ++ k) {
+			if (max[k] - min[k] > max[axis] - min[axis]) axis = k;
+		}
+
+		const size_t pivot = start + (end - start) / 2;
+		std::nth_element(
+		INDEX.begin() + start, INDEX.begin() + pivot, INDEX.begin() + end,
+		[&mid, axis](ptrdiff_t a, ptrdiff_t b) { return mid(a, axis) < mid(b, axis); });
+
+		build(2 * node + 1, start, pivot, rect);
+		build(2 * node + 2, pivot, end, rect);
+		const t_rect &left = NODE[2 * node + 1], &right = NODE[2 * node + 2];
+		for (int k = 0; k < N; ++ k) {
+			NODE[node].min[k] = std::min(left.min[k], right.min[k]);
+			NODE[node].max[k] = std::max(left.max[k], right.max[k]);
+		}
+	}
+
+	void build() {
+
+		const size_t num = RECT.size();
+
+		//Leaves are stored too, so the array has one level more than the tree of t_tree:
+		size_t depth = 0;
+		for (size_t m = num; m > BUCKET; m = (m + 1) / 2) ++ depth;
+		NODE.resize((size_t(2) << depth) - 1);
+
+		INDEX.resize(num);
+		for (size_t i = 0; i < num; ++ i) {
+			INDEX[i] = i;
+		}
+		if (num > 0) build(0, 0, num, RECT);
+
+		//Boxes are reordered to scan buckets contiguously:
+		std::vector<t_rect> rect(num);
+		for (size_t i = 0; i < num; ++ i) rect[i] = RECT[INDEX[i]];
+		RECT.swap(rect);
+	}
+
+	t_bvh(const t_bvh &) = delete;
+
+	std::vector<t_rect> NODE;
+	std::vector<ptrdiff_t> INDEX;
+	std::vector<t_rect> RECT;
 };
 
 //...
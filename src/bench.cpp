@@ -0,0 +1,319 @@
+#include <geom/geom.hpp>
+#include "mesh.hpp"
+#include "file.hpp"
+
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <new>
+#include <set>
+
+using namespace GEOM::BASE;
+using namespace GEOM::MESH;
+using namespace GEOM::METH;
+using namespace GEOM::FILE;
+using namespace GEOM;
+
+//Number of heap allocations (all but aligned ones):
+static std::atomic<size_t> ALLOC{0};
+
+void *operator new(size_t size) {
+	++ ALLOC;
+	if (void *ptr = std::malloc(size? size: 1)) return ptr;
+	throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+//Keeps result of benchmark from being optimized out:
+static volatile size_t SINK;
+
+struct t_result {
+	std::string name;
+	size_t runs;
+	double time;
+	double allocs;
+};
+
+//Runs every benchmark matching the filter until the given time is spent:
+struct t_bench {
+
+	void run(const std::string &name, const std::function<void()> &func) {
+
+		typedef std::chrono::steady_clock t_clock;
+
+		if (name.find(FILTER) == std::string::npos) return;
+
+		func();
+		size_t num = 0;
+		const size_t alloc = ALLOC;
+		const auto start = t_clock::now();
+		std::chrono::duration<double> spent;
+		do {
+			func(); ++ num;
+			spent = t_clock::now() - start;
+		}
+		while (spent.count() < TIME);
+
+		const t_result result{name, num, spent.count() / num * 1.e9, double(ALLOC - alloc) / num};
+		std::cerr << std::left << std::setw(40) << result.name << std::right << std::setw(14)
+		          << std::fixed << std::setprecision(1) << result.time << " ns  "
+		          << std::setw(8) << result.runs << " runs  " << std::setw(10) << result.allocs << " allocs\n";
+		LIST.push_back(result);
+	}
+
+	//Output is laid out like the one of Google Benchmark (--benchmark_format=json):
+	void json(std::ostream &out) const {
+		char date[64];
+		const std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+		out << "{\n  \"context\": {\n";
+		out << "    \"date\": \"" << date << "\",\n";
+		out << "    \"library\": \"MDGeom\",\n";
+		out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+		out << "    \"min_time\": " << TIME << "\n";
+		out << "  },\n  \"benchmarks\": [\n";
+		for (size_t i = 0; i < LIST.size(); ++ i) {
+			const auto &result = LIST[i];
+			out << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.runs
+			    << ", \"real_time\": " << std::fixed << std::setprecision(1) << result.time << ", \"time_unit\": \"ns\""
+			    << ", \"allocs_per_iteration\": " << std::setprecision(3) << result.allocs << "}"
+			    << ((i + 1 < LIST.size())? ",\n": "\n");
+		}
+		out << "  ]\n}\n";
+	}
+
+	std::string FILTER;
+	double TIME = 0.1;
+	std::vector<t_result> LIST;
+};
+
+#ifdef GEOM_STATS
+//Prints stage times of the last call, which show what level of the builder dominates:
+static void printStats(const std::string &name) {
+	const auto &stats = getStats();
+	std::cerr << name << ": " << stats.VERT << " verts, " << stats.EDGE << " crossed edges, "
+	          << std::fixed << std::setprecision(1) << stats.TOTAL * 1.e6 << " us total\n";
+	for (size_t k = 0; k < stats.TIME.size(); ++ k) {
+		std::cerr << "  level " << k << ": " << std::setw(10) << stats.TIME[k] * 1.e6 << " us  "
+		          << std::setw(10) << stats.CELL[k] << " cells\n";
+	}
+	std::cerr << "  workspace growth: " << stats.ALLOC << " bytes\n";
+}
+#endif
+
+template <typename T, unsigned N> static std::vector<t_vector<T, N>> getRandVert(size_t num, unsigned seed) {
+	std::mt19937 gen(seed);
+	std::uniform_real_distribution<T> rnd(-1, 1);
+	std::vector<t_vector<T, N>> vert(num);
+	for (auto &v: vert) for (unsigned k = 0; k < N; ++ k) v[k] = rnd(gen);
+	return vert;
+}
+
+template <unsigned N> static void benchDim(t_bench &bench, int n) {
+
+	typedef double T;
+
+	const std::string tail = "/N:" + std::to_string(N) + "/n:" + std::to_string(n);
+	const auto mesh = getRectGrid<N, T>(n);
+	const auto &vert = mesh.vert();
+
+	//Plane goes through the grid off its vertices:
+	t_vector<T, N> center; for (unsigned k = 0; k < N; ++ k) center[k] = T(0.01) * (k + 1);
+	const auto plane = t_basis<T, N, N - 1>(center).rot(0, N - 1, 0.3);
+	const auto normal = plane.template ext<N>()[N - 1];
+
+	bench.run("vector/dot" + tail, [&]() {
+		T sum = 0;
+		for (const auto &v: vert) sum += (v - center) * normal;
+		SINK = sum > 0;
+	});
+	bench.run("vector/len" + tail, [&]() {
+		T sum = 0;
+		for (const auto &v: vert) sum += (v + normal).len();
+		SINK = sum > 0;
+	});
+	bench.run("basis/put" + tail, [&]() {
+		T sum = 0;
+		for (const auto &v: vert) sum += plane.put(v)[0];
+		SINK = sum > 0;
+	});
+	bench.run("basis/get" + tail, [&]() {
+		T sum = 0;
+		for (const auto &v: vert) sum += plane.get(plane.put(v))[N - 1];
+		SINK = sum > 0;
+	});
+	bench.run("expr/chain" + tail, [&]() {
+		const t_mesh<T, N, N> move = mesh.rot(0, N - 1, 0.1).mov(normal).rot(0, 1, 0.2).mov(center);
+		SINK = move.vert().size();
+	});
+	bench.run("mesh/make" + tail, [&]() { SINK = getRectGrid<N, T>(n).vert().size(); });
+	bench.run("axis/dot" + tail, [&]() {
+		std::vector<T> dist(mesh.axis().size());
+		mesh.axis().dot(center, normal, dist.data());
+		SINK = dist.size();
+	});
+	//New mesh (e.g. every frame of animation) has to build coordinate-wise copy first:
+	bench.run("axis/make/dot" + tail, [&]() {
+		const AXIS::t_axis<T, N> axis(vert.data(), vert.size());
+		std::vector<T> dist(axis.size());
+		axis.dot(center, normal, dist.data());
+		SINK = dist.size();
+	});
+	const t_mesh<T, N, N> plain(vert, mesh.share());
+	bench.run("mesh/dot" + tail, [&]() {
+		std::vector<T> dist(plain.vert().size());
+		plain.dot(center, normal, dist.data());
+		SINK = dist.size();
+	});
+
+	bench.run("getProject" + tail, [&]() { SINK = getProject(mesh, plane).vert().size(); });
+	bench.run("getSection" + tail, [&]() { SINK = getSection(mesh, plane).vert().size(); });
+	bench.run("getClipped" + tail, [&]() { SINK = getClipped(mesh, center, normal).vert().size(); });
+	bench.run("getSection/moved" + tail, [&]() {
+		const t_mesh<T, N, N> move = mesh.mov(normal);
+		SINK = getSection(move, plane).vert().size();
+	});
+#ifdef GEOM_STATS
+	if (("stats" + tail).find(bench.FILTER) != std::string::npos) {
+		getSection(mesh, plane); printStats("getSection" + tail);
+		getClipped(mesh, center, normal); printStats("getClipped" + tail);
+	}
+#endif
+
+	const auto point = getRandVert<T, N>(256, N);
+	bench.run("tree/make" + tail, [&]() { SINK = TREE::t_tree<T, N>(vert.data(), vert.size()).size(); });
+	bench.run("tree/nearest" + tail, [&]() {
+		size_t sum = 0;
+		for (const auto &p: point) sum += mesh.tree().nearest(p, 8).size();
+		SINK = sum;
+	});
+	bench.run("tree/within" + tail, [&]() {
+		size_t sum = 0;
+		for (const auto &p: point) sum += mesh.tree().within(p, T(2) / n).size();
+		SINK = sum;
+	});
+
+	std::stringstream text, data;
+	text << std::setprecision(17) << mesh;
+	writeBinary(data, mesh, true);
+	bench.run("file/text/write" + tail, [&]() {
+		std::stringstream out; out << std::setprecision(17) << mesh; SINK = out.tellp();
+	});
+	bench.run("file/text/read" + tail, [&]() {
+		std::stringstream src(text.str()); t_mesh<T, N, N> copy; src >> copy; SINK = copy.vert().size();
+	});
+	bench.run("file/binary/write" + tail, [&]() {
+		std::stringstream out; writeBinary(out, mesh); SINK = out.tellp();
+	});
+	bench.run("file/binary/read" + tail, [&]() {
+		std::stringstream src(data.str()); t_mesh<T, N, N> copy; readBinary(src, copy); SINK = copy.vert().size();
+	});
+}
+
+//Simplicial lattice over the same grid (N! simplices per cube):
+template <unsigned N> static void benchTetr(t_bench &bench, int n) {
+
+	typedef double T;
+
+	const std::string tail = "/N:" + std::to_string(N) + "/n:" + std::to_string(n);
+	const auto mesh = getTetrGrid<N, T>(n);
+
+	t_vector<T, N> center; for (unsigned k = 0; k < N; ++ k) center[k] = T(0.01) * (k + 1);
+	const auto plane = t_basis<T, N, N - 1>(center).rot(0, N - 1, 0.3);
+	const auto normal = plane.template ext<N>()[N - 1];
+
+	TASK::t_pool pool;
+	bench.run("tetr/make" + tail, [&]() { SINK = getTetrGrid<N, T>(n).vert().size(); });
+	bench.run("tetr/make/pool" + tail, [&]() { SINK = getTetrGrid<N, T>(n, pool).vert().size(); });
+	bench.run("tetr/getSection" + tail, [&]() { SINK = getSection(mesh, plane).vert().size(); });
+	bench.run("tetr/getClipped" + tail, [&]() { SINK = getClipped(mesh, center, normal).vert().size(); });
+}
+
+int main(int argc, char *argv[]) {
+
+	t_bench bench;
+	std::string path;
+	for (int i = 1; i < argc; ++ i) {
+		if (!std::strcmp(argv[i], "--json") && (i + 1 < argc)) { path = argv[++ i]; continue; }
+		if (!std::strcmp(argv[i], "--filter") && (i + 1 < argc)) { bench.FILTER = argv[++ i]; continue; }
+		if (!std::strcmp(argv[i], "--time") && (i + 1 < argc)) { bench.TIME = std::atof(argv[++ i]); continue; }
+		std::cerr << "Usage: " << argv[0] << " [--json FILE|-] [--filter TEXT] [--time SECONDS]\n";
+		return 1;
+	}
+
+	//Grid sizes are picked to have comparable numbers of cells of all dimensions:
+	for (int n: {64, 256}) benchDim<2>(bench, n);
+	for (int n: {16, 32}) benchDim<3>(bench, n);
+	for (int n: {6, 10}) benchDim<4>(bench, n);
+	for (int n: {3, 5}) benchDim<5>(bench, n);
+	for (int n: {2, 3}) benchDim<6>(bench, n);
+
+	benchTetr<2>(bench, 128);
+	benchTetr<3>(bench, 16);
+	benchTetr<4>(bench, 5);
+
+	{
+		//Child indices of new cells are collected for faces of the grid (like in sections):
+		const auto mesh = getRectGrid<3>(32);
+		bench.run("unique/set/N:3/n:32", [&]() {
+			size_t sum = 0;
+			for (const auto &face: mesh.face()) {
+				std::set<int> item;
+				for (int e: face) for (int v: mesh.edge()[e]) item.insert(v);
+				sum += item.size();
+			}
+			SINK = sum;
+		});
+		bench.run("unique/scratch/N:3/n:32", [&]() {
+			size_t sum = 0;
+			t_scratch item;
+			for (const auto &face: mesh.face()) {
+				item.clear();
+				for (int e: face) item.insert(mesh.edge()[e].begin(), mesh.edge()[e].end());
+				item.sort();
+				sum += item.size();
+			}
+			SINK = sum;
+		});
+
+		//Temporaries are kept in the workspace, only the result is allocated:
+		const auto plane = t_space<3, 2>(t_vector_3d{0.01, 0.02, 0.03}).rot(0, 2, 0.3).rot(1, 2, 0.2);
+		const auto normal = plane.ext<3>()[2];
+		TASK::t_pool pool(1);
+		t_sect_work<double> work;
+		bench.run("getSection/work/N:3/n:32", [&]() { SINK = getSection(mesh, plane, pool, work).face().size(); });
+		bench.run("getClipped/work/N:3/n:32", [&]() {
+			SINK = getClipped(mesh, plane.center(), normal, pool, work).body().size();
+		});
+
+		//Float vertices take half the memory, mixed mode classifies them in double:
+		const auto meshf = getRectGrid<3, float>(32);
+		const auto planef = t_space_f<3, 2>(t_vector_3f{0.01f, 0.02f, 0.03f}).rot(0, 2, 0.3f).rot(1, 2, 0.2f);
+		t_sect_work<float> workf;
+		bench.run("getSection/float/N:3/n:32", [&]() { SINK = getSection(meshf, planef, pool, workf).face().size(); });
+		bench.run("getSection/mixed/N:3/n:32", [&]() { SINK = getSection(meshf, plane, pool, work).face().size(); });
+	}
+
+	if (path == "-") {
+		bench.json(std::cout);
+	}
+	else if (!path.empty()) {
+		std::ofstream out(path);
+		bench.json(out);
+	}
+
+	return 0;
+}
@@ -125,12 +125,11 @@ void runTest3D(std::ostream &fout, const t_mesh<double, 3, M> &mesh, t_test test
 	}
 }
 
-template <unsigned M>
-void runTest4D(std::ostream &fout, const t_mesh<double, 4, M> &mesh, t_test test) {
+template <unsigned M, typename F>
+void runTest4D(const t_mesh<double, 4, M> &mesh, t_test test, int n, F &&frame) {
 
 	auto MESH = mesh;
 
-	const int n = 100; fout << n << "\n\n";
 	for (int t = 0; t < n; ++ t) {
 
 		std::cout << ":: " << t;
@@ -138,10 +137,10 @@ void runTest4D(std::ostream &fout, const t_mesh<double, 4, M> &mesh, t_test test
 
 		switch (test) {
 		case PROJECT:
-			fout << getProject(MESH, t_space<4, 3>()) << "\n\n";
+			frame(getProject(MESH, t_space<4, 3>()));
 			break;
 		case SLICING:
-			fout << getSection(MESH, t_space<4, 3>()) << "\n\n";
+			frame(getSection(MESH, t_space<4, 3>()));
 			break;
 		default:
 			assert(false);
@@ -160,6 +159,26 @@ void runTest4D(std::ostream &fout, const t_mesh<double, 4, M> &mesh, t_test test
 	}
 }
 
+template <unsigned M>
+void runTest4D(std::ostream &fout, const t_mesh<double, 4, M> &mesh, t_test test) {
+
+	const int n = 100; fout << n << "\n\n";
+	runTest4D(mesh, test, n, [&](const auto &frame) {
+		fout << frame << "\n\n";
+	});
+}
+
+//Frames are written to binary file on the background thread:
+template <unsigned M>
+void runTest4D(const std::string &fname, const t_mesh<double, 4, M> &mesh, t_test test) {
+
+	std::ofstream fout(fname, std::ios::binary);
+	t_frame_writer<double, 3, t_sect_reduce<4, M>::dim> writer(fout);
+	runTest4D(mesh, test, 100, [&](const auto &frame) {
+		writer.push(frame);
+	});
+}
+
 int main() {
 
 	std::ofstream fout("test.txt");
@@ -172,6 +191,7 @@ int main() {
 	//runTest4D(fout, getRectSurf4D(POLYTOP), PROJECT);
 	//runTest4D(fout, getRectMesh4D(POLYTOP), SLICING);
 	//runTest4D(fout, getRectSurf4D(POLYTOP), SLICING);
+	//runTest4D("test.bin", getRectMesh4D(POLYTOP), PROJECT);
 
 	//Tests for 3D:
 	//runTest3D(fout, getRectMesh3D(SIMPLEX), CUTTING);
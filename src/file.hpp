@@ -1,7 +1,31 @@
 #pragma once
 #include <geom/base.hpp>
 #include <geom/mesh.hpp>
+#include <condition_variable>
+#include <exception>
+#include <type_traits>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <istream>
 #include <ostream>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <cstring>
+#include <cctype>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace GEOM {
 
@@ -10,6 +34,21 @@ using namespace MESH;
 
 namespace FILE {
 
+template <unsigned N> std::ostream &operator << (std::ostream &out, const t_grid<N> &grid);
+inline std::ostream &operator << (std::ostream &out, const t_grid<1> &grid);
+template <unsigned N> std::istream &operator >> (std::istream &src, t_grid<N> &grid);
+inline std::istream &operator >> (std::istream &src, t_grid<1> &grid);
+inline std::ostream &writeBinary(std::ostream &out, const t_grid<1> &grid, bool links);
+inline std::istream &readBinary(std::istream &src, t_grid<1> &grid, size_t vert_num, bool links);
+
+//Fills links of all levels from cells:
+template <unsigned N, unsigned M = 1> void fill(t_grid<N> &grid) {
+	t_hand<N, M>::fill(grid, grid.template cell<M>());
+	if constexpr (M < N) {
+		fill<N, M + 1>(grid);
+	}
+}
+
 template <typename T, unsigned N, unsigned M>
 std::ostream &operator << (std::ostream &out, const t_mesh<T, N, M> &mesh) {
 
@@ -65,6 +104,8 @@ std::istream &operator >> (std::istream &src, t_mesh<T, N, M> &mesh) {
 
 	t_grid<M> grid;
 	src >> grid;
+	if (!src) return src;
+	fill(grid);
 
 	mesh = t_mesh<T, N, M>(
 		std::move(vert),
@@ -74,16 +115,29 @@ std::istream &operator >> (std::istream &src, t_mesh<T, N, M> &mesh) {
 	return src;
 }
 
+//Reads cell index, negative values and values out of the range of the index type set failbit:
+inline std::istream &readIndex(std::istream &src, t_index &i) {
+	long long val = 0;
+	if ((src >> val) && ((val < 0) || (uintmax_t(val) > uintmax_t(std::numeric_limits<t_index>::max())))) {
+		src.setstate(std::ios_base::failbit);
+	}
+	i = t_index(val);
+	return src;
+}
+
 template <unsigned N>
 std::istream &operator >> (std::istream &src, t_grid<N> &grid) {
 
 	src >> grid.template grid<N - 1>();
 
 	auto &cell = grid.template cell<N>();
-	size_t n; src >> n; cell.resize(n);
-	for (auto &c: cell) {
+	size_t n; src >> n; cell.clear();
+	cell.reserve(n);
+	t_cell<N> c;
+	for (size_t k = 0; k < n; ++ k) {
 	size_t m; src >> m; c.resize(m);
-	for (int &i: c) src >> i;
+	for (auto &i: c) readIndex(src, i);
+	cell.push_back(c);
 	}
 
 	return src;
@@ -95,13 +149,799 @@ std::istream &operator >> (std::istream &src, t_grid<1> &grid) {
 	size_t n; src >> n;
 	edge.resize(n);
 	for (auto &e: edge) {
-	src >> e[0];
-	src >> e[1];
+	readIndex(src, e[0]);
+	readIndex(src, e[1]);
 	}
 
 	return src;
 }
 
+//Parser of the text format working on the whole buffer without stream state:
+struct t_text_parser {
+
+	template <typename V> bool next(V &val) {
+		while ((POS != END) && std::isspace(static_cast<unsigned char>(*POS))) ++ POS;
+		//from_chars does not accept the plus sign, so it is skipped only before a digit or point
+		//(as stream extraction does, "+-5" and "+ 3" are rejected):
+		if ((END - POS > 1) && (*POS == '+') &&
+		    (std::isdigit(static_cast<unsigned char>(POS[1])) || (POS[1] == '.'))) ++ POS;
+		const auto res = std::from_chars(POS, END, val);
+		if (res.ec != std::errc()) return false;
+		POS = res.ptr;
+		return true;
+	}
+
+	template <unsigned N> bool next(t_grid<N> &grid, size_t vert_num) {
+
+		if constexpr (N == 1) {
+			auto &edge = grid.template cell<1>();
+			size_t num;
+			if (!next(num)) return false;
+			edge.resize(num);
+			for (auto &e: edge) {
+				if (!next(e[0]) || !next(e[1]) ||
+				    (e[0] < 0) || (e[1] < 0) || (size_t(e[0]) >= vert_num) || (size_t(e[1]) >= vert_num)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		else {
+			if (!next(grid.template grid<N - 1>(), vert_num)) return false;
+
+			const size_t max = grid.template cell<N - 1>().size();
+			size_t num;
+			if (!next(num)) return false;
+			std::vector<size_t> offs(1, 0);
+			std::vector<t_index> item;
+			offs.reserve(num + 1);
+			for (size_t k = 0; k < num; ++ k) {
+				size_t len;
+				if (!next(len)) return false;
+				for (size_t j = 0; j < len; ++ j) {
+					//Values out of the range of the index type are not parsed:
+					t_index i;
+					if (!next(i) || (i < 0) || (size_t(i) >= max)) return false;
+					item.push_back(i);
+				}
+				offs.push_back(item.size());
+			}
+			grid.template cell<N>() = t_list<N>(std::move(offs), std::move(item));
+			return true;
+		}
+	}
+
+	const char *POS, *END;
+};
+
+//Parses mesh written by operator << from the buffer,
+//returns the end of parsed text or nullptr on error:
+template <typename T, unsigned N, unsigned M>
+const char *parseText(const char *start, const char *end, t_mesh<T, N, M> &mesh) {
+
+	t_text_parser text{start, end};
+	size_t n, m, num;
+	if (!text.next(n) || !text.next(m) || (n != N) || (m != M) || !text.next(num)) {
+		return nullptr;
+	}
+
+	std::vector<t_vert<T, N>> vert(num);
+	for (auto &v: vert)
+	for (int k = 0; k < N; ++ k) {
+		if (!text.next(v[k])) return nullptr;
+	}
+
+	t_grid<M> grid;
+	if (!text.next(grid, num)) {
+		return nullptr;
+	}
+	fill(grid);
+
+	mesh = t_mesh<T, N, M>(
+		std::move(vert),
+		std::move(grid)
+	);
+
+	return text.POS;
+}
+
+//Reads the rest of the stream at once and parses one mesh from it,
+//the stream is left right after the mesh if it can seek:
+template <typename T, unsigned N, unsigned M>
+std::istream &readText(std::istream &src, t_mesh<T, N, M> &mesh) {
+
+	const std::streampos start = src.tellg();
+	std::ostringstream buf;
+	buf << src.rdbuf();
+	const std::string data = buf.str();
+
+	const char *end = parseText(data.data(), data.data() + data.size(), mesh);
+	if (end == nullptr) {
+		src.setstate(std::ios_base::badbit);
+		return src;
+	}
+	if (start != std::streampos(-1)) {
+		src.clear();
+		src.seekg(start + std::streamoff(end - data.data()));
+	}
+	return src;
+}
+
+//Binary format (version 1), all numbers are little-endian:
+//
+//  header (64 bytes): "MDGM", version, N, M, size of scalar, size of index (all uint32),
+//                     number of vertices (uint64), flags (uint32), zero padding;
+//  vertices:          number * N scalars;
+//  edges:             number (uint64), number * 2 indices;
+//  cells of M > 1:    number (uint64), number of indices (uint64),
+//                     number + 1 offsets (uint64), indices.
+//
+//If BINARY_LINKS flag is set, every level of cells is followed by links from the level below
+//stored the same way as cells of M > 1, otherwise links are rebuilt on reading.
+//Every block is padded by zeros to the multiple of 8 bytes, so blocks are aligned
+//in the file and can be used in place (see mapBinary).
+
+static constexpr char BINARY_MAGIC[4] = {'M', 'D', 'G', 'M'};
+static constexpr uint32_t BINARY_VERSION = 1;
+static constexpr uint32_t BINARY_LINKS = 1;
+static constexpr size_t BINARY_HEADER = 64;
+static constexpr size_t BINARY_ALIGN = 8;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+static constexpr bool BINARY_SWAP = true;
+#else
+static constexpr bool BINARY_SWAP = false;
+#endif
+
+//Header fields:
+struct t_binary_head {
+	uint32_t VERSION, N, M, SCALAR, INDEX;
+	uint64_t SIZE;
+	uint32_t FLAGS;
+};
+
+template <typename V> void swapBytes(V *data, size_t num) {
+	for (size_t i = 0; i < num; ++ i) {
+		auto *byte = reinterpret_cast<unsigned char *>(data + i);
+		std::reverse(byte, byte + sizeof(V));
+	}
+}
+
+inline size_t padBytes(size_t len) {
+	return (BINARY_ALIGN - len % BINARY_ALIGN) % BINARY_ALIGN;
+}
+
+template <typename V> void writeRaw(std::ostream &out, const V *data, size_t num) {
+
+	static_assert(std::is_trivially_copyable<V>::value);
+	if (BINARY_SWAP) {
+		//Converted by chunks not to copy the whole block:
+		V temp[1024];
+		for (size_t i = 0; i < num; i += 1024) {
+			const size_t len = std::min<size_t>(num - i, 1024);
+			std::copy(data + i, data + i + len, temp);
+			swapBytes(temp, len);
+			out.write(reinterpret_cast<const char *>(temp), len * sizeof(V));
+		}
+	}
+	else {
+		out.write(reinterpret_cast<const char *>(data), num * sizeof(V));
+	}
+	const char zero[BINARY_ALIGN] = {};
+	out.write(zero, padBytes(num * sizeof(V)));
+}
+
+template <typename V> void readRaw(std::istream &src, V *data, size_t num) {
+
+	static_assert(std::is_trivially_copyable<V>::value);
+	src.read(reinterpret_cast<char *>(data), num * sizeof(V));
+	if (BINARY_SWAP) {
+		swapBytes(data, num);
+	}
+	src.ignore(padBytes(num * sizeof(V)));
+}
+
+//Number of bytes left in the stream (SIZE_MAX if it is not seekable):
+inline size_t leftBytes(std::istream &src) {
+	const auto pos = src.tellg();
+	if (pos < 0) return SIZE_MAX;
+	src.seekg(0, std::ios_base::end);
+	const auto end = src.tellg();
+	src.seekg(pos);
+	return (end < pos)? SIZE_MAX: size_t(end - pos);
+}
+
+//Reads block of num items stored as scalars S. Counts of corrupt files are not trusted: the block
+//must fit into the rest of the stream, and if its size is unknown the block grows while it is read.
+//Returns false (with failbit set) if the block is too long:
+template <typename V, typename S = V> bool readBlock(std::istream &src, std::vector<V> &data, size_t num) {
+
+	static_assert(std::is_trivially_copyable<V>::value && (sizeof(V) % sizeof(S) == 0));
+	const size_t left = leftBytes(src);
+	if ((num > (SIZE_MAX - BINARY_ALIGN) / sizeof(V)) || ((left != SIZE_MAX) && (num * sizeof(V) > left))) {
+		src.setstate(std::ios_base::failbit);
+		return false;
+	}
+	const size_t step = (left != SIZE_MAX)? num: (size_t(1) << 20) / sizeof(V) + 1;
+	data.clear();
+	for (size_t i = 0; (i < num) && src; i += step) {
+		const size_t len = std::min(num - i, step);
+		data.resize(i + len);
+		src.read(reinterpret_cast<char *>(data.data() + i), len * sizeof(V));
+	}
+	if (BINARY_SWAP) {
+		swapBytes(reinterpret_cast<S *>(data.data()), data.size() * (sizeof(V) / sizeof(S)));
+	}
+	src.ignore(padBytes(num * sizeof(V)));
+	return bool(src);
+}
+
+template <typename V> void writeRaw(std::ostream &out, V data) {
+	writeRaw(out, &data, 1);
+}
+
+template <typename V> V readRaw(std::istream &src) {
+	V data = 0; readRaw(src, &data, 1); return data;
+}
+
+inline void writeHead(std::ostream &out, t_binary_head head, const char *magic = BINARY_MAGIC) {
+	char data[BINARY_HEADER] = {};
+	if (BINARY_SWAP) {
+		swapBytes(&head.VERSION, 5);
+		swapBytes(&head.SIZE, 1);
+		swapBytes(&head.FLAGS, 1);
+	}
+	std::memcpy(data, magic, 4);
+	std::memcpy(data + 4, &head.VERSION, 20);
+	std::memcpy(data + 24, &head.SIZE, 8);
+	std::memcpy(data + 32, &head.FLAGS, 4);
+	out.write(data, BINARY_HEADER);
+}
+
+//Returns false for unknown files:
+inline bool readHead(const char *data, t_binary_head &head, const char *magic = BINARY_MAGIC) {
+	std::memcpy(&head.VERSION, data + 4, 20);
+	std::memcpy(&head.SIZE, data + 24, 8);
+	std::memcpy(&head.FLAGS, data + 32, 4);
+	if (BINARY_SWAP) {
+		swapBytes(&head.VERSION, 5);
+		swapBytes(&head.SIZE, 1);
+		swapBytes(&head.FLAGS, 1);
+	}
+	return !std::memcmp(data, magic, 4) && (head.VERSION == BINARY_VERSION) &&
+	       !(head.FLAGS & ~BINARY_LINKS) && (head.INDEX == sizeof(t_index)) &&
+	       ((head.SCALAR == sizeof(float)) || (head.SCALAR == sizeof(double)));
+}
+
+//Checks that all indices refer to existing items of the lower level:
+template <typename I> bool checkIndex(const I *item, size_t num, size_t max) {
+	return std::all_of(item, item + num, [max](I i) { return (i >= 0) && (size_t(i) < max); });
+}
+
+//Checks compressed rows: offsets start from zero, do not decrease and end by the number of items:
+inline bool checkOffs(const size_t *offs, size_t num, size_t len) {
+	return (offs[0] == 0) && (offs[num] == len) && std::is_sorted(offs, offs + num + 1);
+}
+
+template <typename I>
+void writeFlat(std::ostream &out, const t_flat<I> &list) {
+
+	const auto &offs = list.offs();
+	const auto &item = list.item();
+	writeRaw<uint64_t>(out, list.size());
+	writeRaw<uint64_t>(out, item.size());
+	if constexpr (sizeof(size_t) == sizeof(uint64_t)) {
+		writeRaw(out, reinterpret_cast<const uint64_t *>(offs.data()), offs.size());
+	}
+	else {
+		writeRaw(out, std::vector<uint64_t>(offs.begin(), offs.end()).data(), offs.size());
+	}
+	writeRaw(out, item.data(), item.size());
+}
+
+template <typename I>
+bool readFlat(std::istream &src, t_flat<I> &list, size_t max) {
+
+	const uint64_t num = readRaw<uint64_t>(src);
+	const uint64_t len = readRaw<uint64_t>(src);
+	if (!src || (num >= SIZE_MAX) || (len >= SIZE_MAX)) return false;
+
+	std::vector<size_t> offs;
+	std::vector<I> item;
+	if constexpr (sizeof(size_t) == sizeof(uint64_t)) {
+		if (!readBlock(src, offs, num + 1)) return false;
+	}
+	else {
+		std::vector<uint64_t> temp;
+		if (!readBlock(src, temp, num + 1)) return false;
+		offs.assign(temp.begin(), temp.end());
+	}
+	if (!readBlock(src, item, len)) return false;
+
+	if (!checkOffs(offs.data(), num, len) || !checkIndex(item.data(), len, max)) {
+		return false;
+	}
+	list = t_flat<I>(std::move(offs), std::move(item));
+	return true;
+}
+
+template <unsigned N>
+std::ostream &writeBinary(std::ostream &out, const t_grid<N> &grid, bool links) {
+
+	writeBinary(out, grid.template grid<N - 1>(), links);
+
+	writeFlat(out, grid.template cell<N>());
+	if (links) {
+		writeFlat(out, grid.template link<N - 1>());
+	}
+	return out;
+}
+
+inline std::ostream &writeBinary(std::ostream &out, const t_grid<1> &grid, bool links) {
+
+	const auto &edge = grid.cell<1>();
+	writeRaw<uint64_t>(out, edge.size());
+	writeRaw(out, reinterpret_cast<const t_index *>(edge.data()), 2 * edge.size());
+	if (links) {
+		writeFlat(out, grid.link<0>());
+	}
+	return out;
+}
+
+template <typename T, unsigned N, unsigned M>
+std::ostream &writeBinary(std::ostream &out, const t_mesh<T, N, M> &mesh, bool links = false) {
+
+	static_assert(sizeof(t_vert<T, N>) == N * sizeof(T));
+
+	writeHead(out, t_binary_head{
+		BINARY_VERSION, N, M, sizeof(T), sizeof(t_index),
+		mesh.vert().size(), links? BINARY_LINKS: 0
+	});
+	writeRaw(out, reinterpret_cast<const T *>(mesh.vert().data()), N * mesh.vert().size());
+	return writeBinary(out, mesh.grid(), links);
+}
+
+template <unsigned N>
+std::istream &readBinary(std::istream &src, t_grid<N> &grid, size_t vert_num, bool links) {
+
+	readBinary(src, grid.template grid<N - 1>(), vert_num, links);
+	if (!src) return src;
+
+	auto &cell = grid.template cell<N>();
+	if (!readFlat(src, cell, grid.template cell<N - 1>().size()) ||
+	    (links && !readFlat(src, grid.template link<N - 1>(), cell.size()))) {
+		src.setstate(std::ios_base::badbit);
+	}
+	return src;
+}
+
+inline std::istream &readBinary(std::istream &src, t_grid<1> &grid, size_t vert_num, bool links) {
+
+	const uint64_t num = readRaw<uint64_t>(src);
+	std::vector<t_edge> edge;
+	if (!src || (num >= SIZE_MAX) || !readBlock<t_edge, t_index>(src, edge, num) ||
+	    !checkIndex(reinterpret_cast<const t_index *>(edge.data()), 2 * edge.size(), vert_num)) {
+		src.setstate(std::ios_base::badbit);
+		return src;
+	}
+	grid.cell<1>() = std::move(edge);
+
+	if (links && !readFlat(src, grid.link<0>(), grid.cell<1>().size())) {
+		src.setstate(std::ios_base::badbit);
+	}
+	return src;
+}
+
+template <typename T, unsigned N, unsigned M>
+std::istream &readBinary(std::istream &src, t_mesh<T, N, M> &mesh) {
+
+	char data[BINARY_HEADER];
+	t_binary_head head;
+	src.read(data, BINARY_HEADER);
+	if (!src || !readHead(data, head) || (head.N != N) || (head.M != M)) {
+		src.setstate(std::ios_base::badbit);
+		return src;
+	}
+
+	//Scalars of other precision are converted:
+	if (head.SIZE >= SIZE_MAX / N) {
+		src.setstate(std::ios_base::badbit);
+		return src;
+	}
+	const size_t size = head.SIZE;
+	std::vector<t_vert<T, N>> vert;
+	bool done;
+	if (head.SCALAR == sizeof(T)) {
+		done = readBlock<t_vert<T, N>, T>(src, vert, size);
+	}
+	else if (head.SCALAR == sizeof(float)) {
+		std::vector<float> temp;
+		done = readBlock(src, temp, N * size);
+		vert.resize(temp.size() / N);
+		std::copy(temp.begin(), temp.end(), reinterpret_cast<T *>(vert.data()));
+	}
+	else {
+		std::vector<double> temp;
+		done = readBlock(src, temp, N * size);
+		vert.resize(temp.size() / N);
+		std::copy(temp.begin(), temp.end(), reinterpret_cast<T *>(vert.data()));
+	}
+	if (!done) {
+		src.setstate(std::ios_base::badbit);
+		return src;
+	}
+
+	t_grid<M> grid;
+	if (!readBinary(src, grid, size, head.FLAGS & BINARY_LINKS)) {
+		return src;
+	}
+	if (!(head.FLAGS & BINARY_LINKS)) {
+		fill(grid);
+	}
+
+	mesh = t_mesh<T, N, M>(
+		std::move(vert),
+		std::move(grid)
+	);
+
+	return src;
+}
+
+//Blocks of mapped file viewed in place:
+struct t_binary_map {
+
+	//Returns false if the file is too short:
+	template <typename V> bool take(t_store<V> &store, size_t num) {
+		const size_t len = num * sizeof(V);
+		if ((num > size_t(END - POS) / sizeof(V)) || (len + padBytes(len) > size_t(END - POS))) {
+			return false;
+		}
+		store = t_store<V>(reinterpret_cast<const V *>(POS), num, HOLD);
+		POS += len + padBytes(len);
+		return true;
+	}
+	bool take(size_t &val) {
+		t_store<uint64_t> store;
+		if (!take(store, 1)) return false;
+		val = std::as_const(store)[0];
+		return true;
+	}
+
+	template <typename I> bool take(t_flat<I> &list, size_t max) {
+		size_t num, len;
+		t_store<size_t> offs;
+		t_store<I> item;
+		if (!take(num) || !take(len) || (num >= SIZE_MAX) || !take(offs, num + 1) || !take(item, len) ||
+		    !checkOffs(std::as_const(offs).data(), num, len) ||
+		    !checkIndex(std::as_const(item).data(), len, max)) {
+			return false;
+		}
+		list = t_flat<I>(std::move(offs), std::move(item));
+		return true;
+	}
+
+	template <unsigned N> bool take(t_grid<N> &grid, size_t vert_num, bool links) {
+		if (!take(grid.template grid<N - 1>(), vert_num, links)) return false;
+		auto &cell = grid.template cell<N>();
+		return take(cell, grid.template cell<N - 1>().size()) &&
+		       (!links || take(grid.template link<N - 1>(), std::as_const(cell).size()));
+	}
+
+	bool take(t_grid<1> &grid, size_t vert_num, bool links) {
+		size_t num;
+		t_list<1> edge;
+		if (!take(num) || !take(edge, num) ||
+		    !checkIndex(reinterpret_cast<const t_index *>(std::as_const(edge).data()), 2 * num, vert_num)) {
+			return false;
+		}
+		grid.cell<1>() = std::move(edge);
+		return !links || take(grid.link<0>(), num);
+	}
+
+	const char *POS, *END;
+	std::shared_ptr<const void> HOLD;
+};
+
+//Loads mesh from the binary file mapped to memory: vertices, cells and stored links are used
+//in place (read-only pages are shared between processes), other arrays are owned by the mesh.
+//Files of other byte order, precision or size of offsets are read by readBinary.
+template <typename T, unsigned N, unsigned M>
+bool mapBinary(const std::string &path, t_mesh<T, N, M> &mesh) {
+
+	static_assert(sizeof(t_vert<T, N>) == N * sizeof(T));
+
+#if defined(__unix__) || defined(__APPLE__)
+	const int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) return false;
+	struct stat info;
+	if ((::fstat(file, &info) != 0) || (size_t(info.st_size) < BINARY_HEADER)) {
+		::close(file);
+		return false;
+	}
+	const size_t size = info.st_size;
+	void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+	::close(file);
+	if (addr == MAP_FAILED) return false;
+
+	t_binary_map map{
+		static_cast<const char *>(addr) + BINARY_HEADER,
+		static_cast<const char *>(addr) + size,
+		std::shared_ptr<const void>(addr, [size](const void *addr) {
+			::munmap(const_cast<void *>(addr), size);
+		})
+	};
+
+	t_binary_head head;
+	if (!readHead(static_cast<const char *>(addr), head) || (head.N != N) || (head.M != M)) {
+		return false;
+	}
+	if (!BINARY_SWAP && (sizeof(size_t) == sizeof(uint64_t)) && (head.SCALAR == sizeof(T))) {
+
+		const bool links = head.FLAGS & BINARY_LINKS;
+		t_store<t_vert<T, N>> vert;
+		t_grid<M> grid;
+		if (!map.take(vert, head.SIZE) || !map.take(grid, head.SIZE, links)) {
+			return false;
+		}
+		if (!links) {
+			fill(grid);
+		}
+		mesh = t_mesh<T, N, M>(
+			std::move(vert),
+			std::move(grid)
+		);
+		return true;
+	}
+#endif
+
+	std::ifstream src(path, std::ios::binary);
+	return bool(readBinary(src, mesh));
+}
+
+//Multi-frame file (version 1):
+//
+//  header (64 bytes): "MDGF", version, N, M, size of scalar, size of index (all uint32), zero padding;
+//  frames:            number of vertices (uint64), vertices, flag of stored grid (uint64),
+//                     grid (as in binary mesh file without links) if the flag is set;
+//  index:             number of frames (uint64), offset of frame and number of frame
+//                     holding its grid (both uint64) for every frame;
+//  trailer:           offset of index (uint64), "MDGI", zero padding.
+//
+//Grid is stored only if it differs from the grid of previous frame.
+
+static constexpr char FRAMES_MAGIC[4] = {'M', 'D', 'G', 'F'};
+static constexpr char FRAMES_INDEX[4] = {'M', 'D', 'G', 'I'};
+
+template <unsigned N> bool equalGrid(const t_grid<N> &grid1, const t_grid<N> &grid2) {
+	if (!(grid1.template cell<N>() == grid2.template cell<N>())) {
+		return false;
+	}
+	if constexpr (N > 1) {
+		return equalGrid(grid1.template grid<N - 1>(), grid2.template grid<N - 1>());
+	}
+	return true;
+}
+
+//Appends frames to the stream, frames can be formatted and written on the background thread
+//(meshes share their data with the queue, so pushing a frame does not copy it). Exception thrown
+//on the background thread stops it and is rethrown by every following push or close (destructor
+//drops it, so close should be called explicitly to learn about failures):
+template <typename T, unsigned N, unsigned M> struct t_frame_writer {
+
+	explicit t_frame_writer(std::ostream &_out, bool _async = true, size_t _depth = 8):
+	                        OUT(_out), BASE(_out.tellp()), DEPTH(std::max<size_t>(_depth, 1)) {
+		writeHead(OUT, t_binary_head{BINARY_VERSION, N, M, sizeof(T), sizeof(t_index), 0, 0}, FRAMES_MAGIC);
+		if (_async) {
+			WORK = std::thread([this]() { loop(); });
+		}
+	}
+
+	~t_frame_writer() {
+		try {
+			close();
+		}
+		catch (...) {
+		}
+	}
+
+	//Waits while the queue is full:
+	void push(const t_mesh<T, N, M> &mesh) {
+		if (!WORK.joinable()) {
+			if (FAIL) {
+				std::rethrow_exception(FAIL);
+			}
+			++ SIZE;
+			write(mesh);
+			return;
+		}
+		std::unique_lock<std::mutex> lock(LOCK);
+		DONE.wait(lock, [this]() { return FAIL || (QUEUE.size() < DEPTH); });
+		if (FAIL) {
+			std::rethrow_exception(FAIL);
+		}
+		++ SIZE;
+		QUEUE.push_back(mesh);
+		WAKE.notify_one();
+	}
+
+	//Writes remaining frames and index:
+	void close() {
+		if (CLOSED && !FAIL) return;
+		if (WORK.joinable()) {
+			{
+			std::lock_guard<std::mutex> lock(LOCK);
+			STOP = true;
+			}
+			WAKE.notify_one();
+			WORK.join();
+		}
+		if (FAIL) {
+			CLOSED = true;
+			std::rethrow_exception(FAIL);
+		}
+		const uint64_t offs = OUT.tellp() - BASE;
+		writeRaw<uint64_t>(OUT, INDEX.size() / 2);
+		writeRaw(OUT, INDEX.data(), INDEX.size());
+		writeRaw<uint64_t>(OUT, offs);
+		const char tail[8] = {FRAMES_INDEX[0], FRAMES_INDEX[1], FRAMES_INDEX[2], FRAMES_INDEX[3]};
+		OUT.write(tail, 8);
+		OUT.flush();
+		CLOSED = true;
+	}
+
+	size_t size() const {
+		return SIZE;
+	}
+
+private:
+	t_frame_writer(const t_frame_writer &) = delete;
+
+	void loop() {
+		for (;;) {
+			std::unique_lock<std::mutex> lock(LOCK);
+			WAKE.wait(lock, [this]() { return STOP || !QUEUE.empty(); });
+			if (QUEUE.empty()) return;
+			const t_mesh<T, N, M> mesh = std::move(QUEUE.front());
+			QUEUE.pop_front();
+			DONE.notify_one();
+			lock.unlock();
+			try {
+				write(mesh);
+			}
+			catch (...) {
+				lock.lock();
+				FAIL = std::current_exception();
+				QUEUE.clear();
+				DONE.notify_all();
+				return;
+			}
+		}
+	}
+
+	void write(const t_mesh<T, N, M> &mesh) {
+
+		//Shared grid is compared by address first:
+		const bool same = (INDEX.size() > 0) && ((&LAST.grid() == &mesh.grid()) ||
+		                  ((LAST.vert().size() == mesh.vert().size()) && equalGrid(LAST.grid(), mesh.grid())));
+		const uint64_t frame = INDEX.size() / 2;
+		if (!same) {
+			GRID = frame;
+		}
+		INDEX.push_back(OUT.tellp() - BASE);
+		INDEX.push_back(GRID);
+
+		writeRaw<uint64_t>(OUT, mesh.vert().size());
+		writeRaw(OUT, reinterpret_cast<const T *>(mesh.vert().data()), N * mesh.vert().size());
+		writeRaw<uint64_t>(OUT, !same);
+		if (!same) {
+			writeBinary(OUT, mesh.grid(), false);
+		}
+		LAST = mesh;
+	}
+
+	std::ostream &OUT;
+	const std::streampos BASE;
+	const size_t DEPTH;
+
+	std::vector<uint64_t> INDEX;
+	t_mesh<T, N, M> LAST;
+	uint64_t GRID = 0;
+	size_t SIZE = 0;
+	bool CLOSED = false;
+
+	std::deque<t_mesh<T, N, M>> QUEUE;
+	std::exception_ptr FAIL;
+	std::condition_variable WAKE;
+	std::condition_variable DONE;
+	std::mutex LOCK;
+	std::thread WORK;
+	bool STOP = false;
+};
+
+//Reads frames written by t_frame_writer in any order:
+template <typename T, unsigned N, unsigned M> struct t_frame_reader {
+
+	//Sets badbit of the stream for unknown or broken files:
+	explicit t_frame_reader(std::istream &_src): SRC(_src), BASE(_src.tellg()) {
+
+		char data[BINARY_HEADER];
+		t_binary_head head;
+		SRC.read(data, BINARY_HEADER);
+		if (!SRC || !readHead(data, head, FRAMES_MAGIC) ||
+		    (head.N != N) || (head.M != M) || (head.SCALAR != sizeof(T))) {
+			SRC.setstate(std::ios_base::badbit);
+			return;
+		}
+
+		char tail[8];
+		SRC.seekg(-16, std::ios_base::end);
+		const uint64_t offs = readRaw<uint64_t>(SRC);
+		SRC.read(tail, 8);
+		if (!SRC || std::memcmp(tail, FRAMES_INDEX, 4)) {
+			SRC.setstate(std::ios_base::badbit);
+			return;
+		}
+		SRC.seekg(BASE + std::streamoff(offs));
+		const uint64_t num = readRaw<uint64_t>(SRC);
+		if (!SRC || (num > SIZE_MAX / 2) || !readBlock(SRC, INDEX, 2 * num)) {
+			SRC.setstate(std::ios_base::badbit);
+			return;
+		}
+		for (size_t k = 0; k < INDEX.size(); k += 2) {
+			if (INDEX[k + 1] > k / 2) SRC.setstate(std::ios_base::badbit);
+		}
+	}
+
+	size_t size() const {
+		return INDEX.size() / 2;
+	}
+
+	bool read(size_t k, t_mesh<T, N, M> &mesh) {
+
+		if (!SRC || (k >= size())) return false;
+
+		//Grid is read once and shared (not copied) by meshes of all frames using it:
+		const size_t g = INDEX[2 * k + 1];
+		if (g != FRAME) {
+			FRAME = -1;
+			SRC.seekg(BASE + std::streamoff(INDEX[2 * g]));
+			const uint64_t num = readRaw<uint64_t>(SRC);
+			if (!SRC || (num > leftBytes(SRC) / (N * sizeof(T)))) {
+				SRC.setstate(std::ios_base::badbit);
+				return false;
+			}
+			SRC.seekg(N * num * sizeof(T) + padBytes(N * num * sizeof(T)), std::ios_base::cur);
+			auto grid = std::make_shared<t_grid<M>>();
+			if (!readRaw<uint64_t>(SRC) || !readBinary(SRC, *grid, num, false)) {
+				SRC.setstate(std::ios_base::badbit);
+				return false;
+			}
+			fill(*grid);
+			GRID = std::move(grid);
+			FRAME = g;
+			SIZE = num;
+		}
+
+		SRC.seekg(BASE + std::streamoff(INDEX[2 * k]));
+		std::vector<t_vert<T, N>> vert;
+		if ((readRaw<uint64_t>(SRC) != SIZE) || !readBlock<t_vert<T, N>, T>(SRC, vert, SIZE)) {
+			SRC.setstate(std::ios_base::badbit);
+			return false;
+		}
+
+		mesh = t_mesh<T, N, M>(std::move(vert), GRID);
+		return true;
+	}
+
+private:
+	std::istream &SRC;
+	const std::streampos BASE;
+	std::vector<uint64_t> INDEX;
+	std::shared_ptr<const t_grid<M>> GRID;
+	size_t FRAME = -1;
+	size_t SIZE = 0;
+};
+
 //...
 
 }//FILE
@@ -2,6 +2,12 @@
 #include <geom/base.hpp>
 #include <geom/mesh.hpp>
 
+#include <utility>
+#include <limits>
+#include <vector>
+#include <array>
+#include <map>
+
 namespace GEOM {
 
 using namespace BASE;
@@ -320,6 +326,191 @@ t_surf_3d getTetrSurf3D() {
 	);
 }
 
+//Regular lattice of n^N blocks filling [-1, 1]^N. Cells are grouped by types: cell of type t
+//is given by its lowest vertex p, which goes up to n - 1 along the axes of TOP and up to n along
+//the others; its items are cells of types ITEM[i].second at vertex p + ITEM[i].first (shift mask).
+//Type 0 must be the vertex, and cells of every level must have the same number of items:
+template <typename T, unsigned N> struct t_lattice {
+
+	struct t_type {
+		std::vector<std::pair<unsigned, int>> ITEM;
+		unsigned TOP = 0;
+		unsigned LEVEL = 0;
+		size_t BASE = 0;
+		size_t SIZE = 0;
+	};
+
+	t_lattice(int n, std::vector<t_type> type): TYPE(std::move(type)), n(n) {
+		assert(n > 0 && !TYPE.empty() && TYPE[0].LEVEL == 0);
+		for (auto &t: TYPE) {
+			t.SIZE = 1;
+			for (unsigned a = 0; a < N; ++ a) t.SIZE *= (t.TOP >> a & 1)? n: n + 1;
+			t.BASE = COUNT[t.LEVEL];
+			COUNT[t.LEVEL] += t.SIZE;
+			checkIndex(COUNT[t.LEVEL]);
+			assert(t.LEVEL == 0 || ITEM[t.LEVEL] == 0 || ITEM[t.LEVEL] == t.ITEM.size());
+			ITEM[t.LEVEL] = t.ITEM.size();
+		}
+	}
+
+	t_mesh<T, N, N> make(TASK::t_pool &pool) const {
+
+		t_store<t_vert<T, N>> vert(COUNT[0]);
+		t_vert<T, N> *vert_data = vert.data();
+		pool.run(COUNT[0], [&](unsigned, size_t start, size_t end) {
+			auto p = point(TYPE[0], start);
+			for (size_t i = start; i < end; ++ i, next(p, TYPE[0])) {
+				for (unsigned a = 0; a < N; ++ a) vert_data[i][a] = T(-1) + T(2) * p[a] / n;
+			}
+		});
+
+		MESH::t_grid<N> grid;
+		fill<1>(grid, pool);
+		return t_mesh<T, N, N>(std::move(vert), std::move(grid));
+	}
+
+	t_mesh<T, N, N> make() const {
+		TASK::t_pool pool(1);
+		return make(pool);
+	}
+
+	//Number of K-cells:
+	size_t size(unsigned k) const {
+		return COUNT[k];
+	}
+
+private:
+	template <unsigned K> void fill(MESH::t_grid<N> &grid, TASK::t_pool &pool) const {
+
+		const size_t num = ITEM[K];
+		t_store<t_index> item(COUNT[K] * num);
+		t_index *item_data = item.data();
+		for (const auto &t: TYPE) {
+			if (t.LEVEL != K) continue;
+			pool.run(t.SIZE, [&](unsigned, size_t start, size_t end) {
+				auto p = point(t, start);
+				for (size_t i = start; i < end; ++ i, next(p, t)) {
+					t_index *out = item_data + (t.BASE + i) * num;
+					for (const auto &l: t.ITEM) {
+						*(out ++) = index(p, l.first, TYPE[l.second]);
+					}
+				}
+			});
+		}
+
+		if constexpr (K == 1) {
+			t_list<1> list(COUNT[1]);
+			for (size_t i = 0; i < COUNT[1]; ++ i) list[i] = {item[2 * i], item[2 * i + 1]};
+			grid.template cell<1>() = std::move(list);
+		}
+		else {
+			t_store<size_t> offs(COUNT[K] + 1);
+			for (size_t i = 0; i <= COUNT[K]; ++ i) offs[i] = i * num;
+			grid.template cell<K>() = t_list<K>(std::move(offs), std::move(item));
+		}
+		t_hand<N, K>::fill(grid, grid.template cell<K>(), pool);
+
+		if constexpr (K < N) {
+			fill<K + 1>(grid, pool);
+		}
+	}
+
+	std::array<int, N> point(const t_type &t, size_t i) const {
+		std::array<int, N> p;
+		for (int a = N - 1; a >= 0; -- a) {
+			const int dim = (t.TOP >> a & 1)? n: n + 1;
+			p[a] = i % dim; i /= dim;
+		}
+		return p;
+	}
+
+	void next(std::array<int, N> &p, const t_type &t) const {
+		for (int a = N - 1; a >= 0; -- a) {
+			if (++ p[a] < ((t.TOP >> a & 1)? n: n + 1)) return;
+			p[a] = 0;
+		}
+	}
+
+	t_index index(const std::array<int, N> &p, unsigned shift, const t_type &t) const {
+		size_t ind = 0;
+		for (unsigned a = 0; a < N; ++ a) {
+			ind = ind * ((t.TOP >> a & 1)? n: n + 1) + p[a] + (shift >> a & 1);
+		}
+		return t.BASE + ind;
+	}
+
+	std::vector<t_type> TYPE;
+	std::array<size_t, N + 1> COUNT{};
+	std::array<size_t, N + 1> ITEM{};
+	int n;
+};
+
+//Grid of n^N cubes: K-cell of type S (set of K axes it goes along) has items
+//of types S \ a at its lowest vertex and at the vertex shifted along a:
+template <unsigned N, typename T = MATH_TYPE> t_lattice<T, N> getRectLattice(int n) {
+
+	std::vector<typename t_lattice<T, N>::t_type> type(1u << N);
+	for (unsigned mask = 0; mask < (1u << N); ++ mask) {
+		auto &t = type[mask];
+		t.TOP = mask;
+		for (unsigned a = 0; a < N; ++ a) {
+			if (!(mask >> a & 1)) continue;
+			t.ITEM.emplace_back(0, mask ^ (1u << a));
+			t.ITEM.emplace_back(1u << a, mask ^ (1u << a));
+			++ t.LEVEL;
+		}
+	}
+	return t_lattice<T, N>(n, std::move(type));
+}
+
+//Freudenthal triangulation of the same grid (N! simplices per cube): K-simplex of type
+//0 = S_0 < S_1 < ... < S_K (chain of axis sets) has vertices p + S_i. Its face without S_0
+//is the chain S_i \ S_1 at vertex p + S_1, faces without other S_j are the rest chains at p:
+template <unsigned N, typename T = MATH_TYPE> t_lattice<T, N> getTetrLattice(int n) {
+
+	std::vector<std::vector<unsigned>> chain{{0}};
+	std::map<std::vector<unsigned>, int> ind{{{0}, 0}};
+	for (size_t c = 0; c < chain.size(); ++ c) {
+		const unsigned last = chain[c].back();
+		for (unsigned mask = last + 1; mask < (1u << N); ++ mask) {
+			if ((mask & last) != last) continue;
+			auto next = chain[c]; next.push_back(mask);
+			ind.emplace(next, chain.size());
+			chain.push_back(std::move(next));
+		}
+	}
+
+	std::vector<typename t_lattice<T, N>::t_type> type(chain.size());
+	for (size_t c = 0; c < chain.size(); ++ c) {
+		const auto &s = chain[c];
+		auto &t = type[c];
+		t.LEVEL = s.size() - 1;
+		t.TOP = s.back();
+		for (int j = t.LEVEL; j >= 0 && t.LEVEL > 0; -- j) {
+			std::vector<unsigned> face;
+			for (size_t i = 0; i < s.size(); ++ i) {
+				if (i != j) face.push_back(s[i] ^ ((j == 0)? s[1]: 0));
+			}
+			t.ITEM.emplace_back((j == 0)? s[1]: 0, ind.at(face));
+		}
+	}
+	return t_lattice<T, N>(n, std::move(type));
+}
+
+template <unsigned N, typename T = MATH_TYPE> t_mesh<T, N, N> getRectGrid(int n, TASK::t_pool &pool) {
+	return getRectLattice<N, T>(n).make(pool);
+}
+template <unsigned N, typename T = MATH_TYPE> t_mesh<T, N, N> getRectGrid(int n) {
+	return getRectLattice<N, T>(n).make();
+}
+
+template <unsigned N, typename T = MATH_TYPE> t_mesh<T, N, N> getTetrGrid(int n, TASK::t_pool &pool) {
+	return getTetrLattice<N, T>(n).make(pool);
+}
+template <unsigned N, typename T = MATH_TYPE> t_mesh<T, N, N> getTetrGrid(int n) {
+	return getTetrLattice<N, T>(n).make();
+}
+
 //...
 
 }//MESH
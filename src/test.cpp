@@ -2,3 +2,6 @@
 
 #include "test/base.cpp"
 #include "test/mesh.cpp"
+#include "test/meth.cpp"
+#include "test/tree.cpp"
+#include "test/file.cpp"
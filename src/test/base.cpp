@@ -86,6 +86,40 @@ BOOST_AUTO_TEST_CASE(test_math, *boost::unit_test::tolerance(MATH_EPSILON)) {
 
 }
 
+template <typename T, unsigned N> static void test_kernel() {
+
+	using namespace GEOM::BASE;
+
+	t_vector<T, N> v1, v2;
+	for (int i = 0; i < N; ++ i) { v1[i] = T(i + 1); v2[i] = T(2 * i - 3); }
+
+	T dot = 0;
+	for (int i = 0; i < N; ++ i) {
+		BOOST_TEST_VAL((v1 + v2)[i], v1[i] + v2[i]);
+		BOOST_TEST_VAL((v1 - v2)[i], v1[i] - v2[i]);
+		BOOST_TEST_VAL((v1 * T(3))[i], v1[i] * T(3));
+		dot += v1[i] * v2[i];
+	}
+	BOOST_TEST_VAL(v1 * v2, dot);
+
+	t_vector<T, N> v3 = v1; v3 += v2; v3 -= v1; v3 *= T(2);
+	BOOST_TEST_VEC(v3, v2 * T(2));
+}
+
+BOOST_AUTO_TEST_CASE(test_kernels) {
+
+	BOOST_TEST_MESSAGE("Testing vector kernels");
+
+	test_kernel<double, 2>();
+	test_kernel<double, 3>();
+	test_kernel<double, 4>();
+	test_kernel<double, 5>();
+	test_kernel<float, 2>();
+	test_kernel<float, 3>();
+	test_kernel<float, 4>();
+
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 //...
@@ -298,6 +332,9 @@ BOOST_AUTO_TEST_CASE(test_expression, *boost::unit_test::tolerance(MATH_EPSILON)
 	BOOST_TEST_VEC(
 	v1, TEST_EXPR(e1)(v0)
 	);
+	BOOST_TEST_VEC(
+	v1, TEST_EXPR(e1).affine()(v0)
+	);
 
 	#undef TEST_EXPR
 }
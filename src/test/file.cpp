@@ -0,0 +1,205 @@
+#include <boost/test/unit_test.hpp>
+#include <geom/meth.hpp>
+#include "../mesh.hpp"
+#include "../file.hpp"
+#include <filesystem>
+#include <iomanip>
+#include <cstdio>
+#include <sstream>
+
+BOOST_AUTO_TEST_SUITE(suite_of_file_tests)
+
+//Stream buffer accepting only the given number of bytes:
+struct t_short_buf: std::streambuf {
+	explicit t_short_buf(size_t size): DATA(size) { setp(DATA.data(), DATA.data() + size); }
+	pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override { return pptr() - pbase(); }
+	std::vector<char> DATA;
+};
+
+template <typename T, unsigned N, unsigned M>
+static void test_stream(const GEOM::MESH::t_mesh<T, N, M> &mesh) {
+
+	using namespace GEOM::FILE;
+
+	std::stringstream text;
+	text << std::scientific << std::setprecision(17) << mesh;
+	GEOM::MESH::t_mesh<T, N, M> mesh1;
+	text >> mesh1;
+	BOOST_TEST(bool(text));
+	BOOST_TEST(suite_of_method_tests::equal_mesh(mesh, mesh1));
+
+	//Fast parser gives the same mesh as operator >>:
+	GEOM::MESH::t_mesh<T, N, M> mesh5;
+	text.clear();
+	text.seekg(0);
+	BOOST_TEST(bool(readText(text, mesh5)));
+	BOOST_TEST(suite_of_method_tests::equal_mesh(mesh1, mesh5));
+	const std::string copy = text.str() + "\n" + text.str();
+	const char *end = parseText(copy.data(), copy.data() + copy.size(), mesh5);
+	BOOST_TEST((end && parseText(end, copy.data() + copy.size(), mesh5)));
+	BOOST_TEST(suite_of_method_tests::equal_mesh(mesh1, mesh5));
+	BOOST_TEST(!parseText(copy.data(), copy.data() + copy.size() / 3, mesh5));
+
+	//Negative indices and indices out of the index range are rejected:
+	std::string body = text.str();
+	body.erase(body.find_last_not_of(" \t\n") + 1);
+	const std::string last = body.substr(body.find_last_of(" \t\n") + 1);
+	body.erase(body.find_last_of(" \t\n") + 1);
+	std::stringstream good(body + last + "\n");
+	BOOST_TEST(bool(good >> mesh5));
+	for (const char *index: {"-1", "18446744073709551616", "+-5", "+ 3"}) {
+		std::stringstream bad(body + index + "\n");
+		BOOST_TEST(!(bad >> mesh5));
+		bad.clear();
+		bad.seekg(0);
+		BOOST_TEST(!readText(bad, mesh5));
+	}
+
+	std::stringstream data(std::ios::in | std::ios::out | std::ios::binary);
+	writeBinary(data, mesh);
+	BOOST_TEST(data.str().size() % 8 == 0);
+	GEOM::MESH::t_mesh<T, N, M> mesh2;
+	readBinary(data, mesh2);
+	BOOST_TEST(bool(data));
+	BOOST_TEST(suite_of_method_tests::equal_mesh(mesh, mesh2));
+
+	//Mapped file is used in place with and without stored links:
+	for (bool links: {false, true}) {
+		const std::string path = (std::filesystem::temp_directory_path() /
+		                         ("test_file_" + std::to_string(N) + std::to_string(M) + ".bin")).string();
+		{
+		std::ofstream file(path, std::ios::binary);
+		writeBinary(file, mesh, links);
+		}
+		GEOM::MESH::t_mesh<T, N, M> mesh4;
+		BOOST_TEST(mapBinary(path, mesh4));
+		BOOST_TEST(mesh4.vert().view());
+		const std::vector<GEOM::MESH::t_vert<T, N>> &vert = mesh4.vert();
+		BOOST_TEST((mesh4.vert() == vert));
+		BOOST_TEST(mesh4.template cell<M>().item().view() == (M > 1));
+		BOOST_TEST(mesh4.template link<0>().item().view() == links);
+		BOOST_TEST(suite_of_method_tests::equal_mesh(mesh, mesh4));
+		std::remove(path.c_str());
+	}
+
+	//Wrong dimensions and truncated data are rejected:
+	GEOM::MESH::t_mesh<T, N + 1, M> mesh3;
+	std::stringstream bad1(data.str());
+	BOOST_TEST(!readBinary(bad1, mesh3));
+	std::stringstream bad2(data.str().substr(0, data.str().size() - 8));
+	BOOST_TEST(!readBinary(bad2, mesh2));
+	for (size_t len: {size_t(32), size_t(64), data.str().size() / 2}) {
+		std::stringstream bad3(data.str().substr(0, len));
+		BOOST_TEST(!readBinary(bad3, mesh2));
+	}
+
+	//Huge counts of corrupt files are rejected without allocation (patterns do not depend on byte order):
+	const size_t vert_pos = 24;
+	const size_t edge_pos = 64 + N * sizeof(T) * mesh.vert().size();
+	const size_t face_pos = edge_pos + 8 + (2 * sizeof(GEOM::MESH::t_index) * mesh.template cell<1>().size() + 7) / 8 * 8;
+	for (size_t pos: {vert_pos, edge_pos, face_pos}) {
+		for (const char *num: {"\xff\xff\xff\xff\xff\xff\xff\xff", "\0\0\xff\xff\xff\xff\0\0"}) {
+			std::string text = data.str();
+			text.replace(pos, 8, num, 8);
+			std::stringstream bad4(text);
+			BOOST_TEST(!readBinary(bad4, mesh2));
+			const std::string path = (std::filesystem::temp_directory_path() / "test_file_bad.bin").string();
+			{
+			std::ofstream file(path, std::ios::binary);
+			file << text;
+			}
+			BOOST_TEST(!mapBinary(path, mesh2));
+			std::remove(path.c_str());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_file) {
+
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing mesh files");
+
+	test_stream(getRectMesh3D(POLYTOP));
+	test_stream<double, 4, 4>(getRectMesh4D(POLYTOP).rot(0, 3, 0.3));
+	test_stream(getSection(getRectMesh3D(POLYTOP), GEOM::BASE::t_plane_3d()));
+}
+
+BOOST_AUTO_TEST_CASE(test_frames) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+	using namespace GEOM::FILE;
+
+	BOOST_TEST_MESSAGE("Testing multi-frame files");
+
+	//Rotated frames share the grid, sections change it:
+	std::vector<t_mesh_3d> list;
+	t_mesh_3d mesh = getRectMesh3D(POLYTOP).rot(0, 2, 0.2).rot(1, 2, 0.3);
+	const t_mesh_4d rect = getRectMesh4D(POLYTOP).rot(0, 3, 0.5);
+	list.push_back(getSection(getRectMesh4D(POLYTOP), t_space<4, 3>()));
+	for (int t = 0; t < 5; ++ t) {
+		list.push_back(mesh);
+		mesh = mesh.rot(0, 1, 0.1);
+	}
+	list.push_back(getSection(rect, t_space<4, 3>()));
+	list.push_back(list.back().mov(t_vector_3d{1., 2., 3.}));
+
+	for (bool async: {false, true}) {
+		std::stringstream data(std::ios::in | std::ios::out | std::ios::binary);
+		{
+		t_frame_writer<double, 3, 3> writer(data, async, 2);
+		for (const auto &frame: list) writer.push(frame);
+		BOOST_TEST(writer.size() == list.size());
+		}
+		t_frame_reader<double, 3, 3> reader(data);
+		BOOST_TEST(bool(data));
+		BOOST_TEST(reader.size() == list.size());
+		for (int k: {3, 0, 7, 1, 2, 6, 5, 4}) {
+			t_mesh_3d frame;
+			BOOST_TEST(reader.read(k, frame));
+			BOOST_TEST(suite_of_method_tests::equal_mesh(frame, list[k]));
+		}
+
+		//Consecutive frames sharing the grid share it in memory too:
+		t_mesh_3d frame1, frame2;
+		BOOST_TEST((reader.read(1, frame1) && reader.read(2, frame2)));
+		BOOST_TEST(&frame1.grid() == &frame2.grid());
+
+		//Huge number of frames and truncated files are rejected:
+		std::string text = data.str();
+		uint64_t offs;
+		std::memcpy(&offs, text.data() + text.size() - 16, 8);
+		text.replace(offs, 8, "\0\0\xff\xff\xff\xff\0\0", 8);
+		std::stringstream bad1(text);
+		t_frame_reader<double, 3, 3> reader1(bad1);
+		BOOST_TEST(!bad1);
+		std::stringstream bad2(data.str().substr(0, data.str().size() / 2) + data.str().substr(offs));
+		t_frame_reader<double, 3, 3> reader2(bad2);
+		t_mesh_3d frame;
+		BOOST_TEST(!(bad2 && reader2.read(7, frame)));
+	}
+
+	//Failure on the background thread is rethrown by push or close:
+	{
+	t_short_buf buf(256);
+	std::ostream out(&buf);
+	t_frame_writer<double, 3, 3> writer(out, true, 2);
+	out.exceptions(std::ios_base::badbit);
+	bool fail = false;
+	try {
+		for (const auto &frame: list) writer.push(frame);
+		writer.close();
+	}
+	catch (const std::ios_base::failure &) {
+		fail = true;
+	}
+	BOOST_TEST(fail);
+	BOOST_CHECK_THROW(writer.close(), std::ios_base::failure);
+	BOOST_CHECK_THROW(writer.push(list[0]), std::ios_base::failure);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,9 +1,12 @@
 #include <boost/test/unit_test.hpp>
 #include <geom/mesh.hpp>
+#include <geom/test.hpp>
+#include "../mesh.hpp"
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE(suite_of_mesh_tests)
 
-template <typename T> static std::vector<std::vector<int>> get_link(const std::vector<T> &item) {
+template <typename L> static std::vector<std::vector<int>> get_link(const L &item) {
 	std::vector<std::vector<int>> link;
 	for (int i = 0; i < item.size(); ++ i) for (int k: item[i]) {
 		if (link.size() <= k) {
@@ -97,8 +100,183 @@ BOOST_AUTO_TEST_CASE(test_constructor) {
 	BOOST_TEST(mesh.link<0>() == get_link(mesh.cell<1>()));
 	BOOST_TEST(mesh.link<1>() == get_link(mesh.cell<2>()));
 	BOOST_TEST(mesh.link<2>() == get_link(mesh.cell<3>()));
+
+	//Check for proxies of parts and links
+	for (auto &b: mesh) {
+		std::vector<int> part;
+		for (auto &f: b) part.push_back(f.id());
+		BOOST_TEST(part == std::vector<int>(body[b.id()].begin(), body[b.id()].end()));
+	}
+	for (int e = 0; e < edge.size(); ++ e) {
+		std::vector<int> link;
+		for (auto &f: mesh.edge(e).link()) link.push_back(f.id());
+		BOOST_TEST(link == get_link(mesh.cell<2>())[e]);
+		BOOST_TEST(mesh.edge(e).link().item().size() == link.size());
+	}
+	}
+	{
+	//Check that meshes too large for the index type are rejected
+	const size_t max = getIndexLimit();
+	BOOST_TEST(max <= size_t(std::numeric_limits<int>::max()));
+	BOOST_CHECK_NO_THROW(checkIndex(max));
+	BOOST_CHECK_THROW(checkIndex(max + 1), std::length_error);
+	if (max < 41 * 41 * 41) {
+		BOOST_CHECK_THROW(getRectGrid<3>(40), std::length_error);
+	}
 	}
 
 }
 
+BOOST_AUTO_TEST_CASE(test_axis, *boost::unit_test::tolerance(MATH_EPSILON)) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+
+	BOOST_TEST_MESSAGE("Testing coordinate-wise vertex storage");
+
+	std::vector<t_mesh<double, 3, 1>::t_vert> vert{
+	{-1, -1, -1}, {-1, +1, +2}, {+3, +1, -1}
+	};
+	std::vector<t_edge> edge{
+	{0, 1}, {1, 2}, {2, 0}
+	};
+	t_vector<double, 3> center{-3., +2., -1.};
+	t_vector<double, 3> normal{+1., -1., -1.};
+
+	t_mesh<double, 3, 1> mesh(vert, edge);
+
+	//Check that distances of the mesh do not depend on the coordinate-wise storage
+	std::vector<double> plain(vert.size());
+	mesh.dot(center, normal, plain.data());
+
+	const auto &axis = mesh.axis();
+	BOOST_TEST(axis.size() == vert.size());
+
+	//Check for coordinates and signed distances
+	std::vector<double> dist(vert.size());
+	axis.dot(center, normal, dist.data());
+	for (int i = 0; i < vert.size(); ++ i) {
+		for (int k = 0; k < 3; ++ k) {
+			BOOST_TEST(axis[k][i] == vert[i][k]);
+		}
+		BOOST_TEST(axis.get(i) == vert[i]);
+		BOOST_TEST(dist[i] == (vert[i] - center) * normal);
+		BOOST_TEST(dist[i] == plain[i]);
+	}
+	mesh.dot(center, normal, plain.data());
+	BOOST_TEST(plain == dist, boost::test_tools::per_element());
+
+	//Check that concurrent requests and copies get the same storage
+	t_mesh<double, 3, 1> copy = mesh.mov(center);
+	std::vector<const void *> addr(8);
+	std::vector<std::thread> list;
+	for (int k = 0; k < addr.size(); ++ k) {
+		list.emplace_back([&, k] { addr[k] = &copy.axis(); });
+	}
+	for (auto &t: list) t.join();
+	for (const void *a: addr) BOOST_TEST(a == &copy.axis());
+	t_mesh<double, 3, 1> same = copy;
+	BOOST_TEST(&same.axis() == &copy.axis());
+	BOOST_TEST(&mesh.axis() == &axis);
+
+}
+
+BOOST_AUTO_TEST_CASE(test_transform, *boost::unit_test::tolerance(1.e-12)) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+
+	BOOST_TEST_MESSAGE("Testing mesh transformations");
+
+	std::vector<t_mesh<double, 3, 1>::t_vert> vert{
+	{-1, -1, -1}, {-1, +1, +2}, {+3, +1, -1}
+	};
+	std::vector<t_edge> edge{
+	{0, 1}, {1, 2}, {2, 0}
+	};
+	t_vector<double, 3> offset{+1., -2., +3.};
+	t_vector<double, 3> center{-3., +2., -1.};
+
+	t_mesh<double, 3, 1> mesh(vert, edge);
+	t_mesh<double, 3, 1> next = mesh.rot(0, 1, M_PI / 3).rot(center, 1, 2, M_PI / 5).mov(offset);
+
+	//Check that mesh topology is shared
+	BOOST_TEST(&next.grid() == &mesh.grid());
+
+	//Check for vertex coordinates
+	for (int i = 0; i < vert.size(); ++ i) {
+		const auto v = vert[i].rot(0, 1, M_PI / 3).rot(center, 1, 2, M_PI / 5).mov(offset);
+		for (int k = 0; k < 3; ++ k) {
+			BOOST_TEST(next.vert()[i][k] == v[k]);
+		}
+	}
+
+}
+
+template <unsigned N, unsigned K = 1, typename T>
+static void check_lattice(const GEOM::MESH::t_mesh<T, N, N> &mesh, const GEOM::MESH::t_mesh<T, N, N> &copy,
+                          std::array<size_t, N + 1> &count) {
+	count[K] = mesh.template cell<K>().size();
+	BOOST_TEST(mesh.template cell<K>() == copy.template cell<K>());
+	BOOST_TEST(mesh.template link<K - 1>() == copy.template link<K - 1>());
+	BOOST_TEST(mesh.template link<K - 1>() == get_link(mesh.template cell<K>()));
+	if constexpr (K < N) {
+		check_lattice<N, K + 1>(mesh, copy, count);
+	}
+}
+
+//Checks counts of cells, topology and links of the grid with given numbers
+//of N-cells per block and of boundary (N-1)-cells per block side:
+template <unsigned N, typename T>
+static void check_grid(const GEOM::MESH::t_mesh<T, N, N> &mesh, const GEOM::MESH::t_mesh<T, N, N> &copy,
+                         int n, size_t blocks, size_t faces) {
+
+	std::array<size_t, N + 1> count{};
+	count[0] = mesh.vert().size();
+	BOOST_TEST(mesh.vert() == copy.vert());
+	check_lattice<N>(mesh, copy, count);
+
+	size_t power = 1;
+	for (unsigned a = 0; a < N; ++ a) power *= n + 1;
+	BOOST_TEST(count[0] == power);
+	power = 1;
+	for (unsigned a = 0; a < N; ++ a) power *= n;
+	BOOST_TEST(count[N] == power * blocks);
+
+	//Grid is contractible:
+	long euler = 0;
+	for (unsigned k = 0; k <= N; ++ k) euler += (k % 2)? - long(count[k]): long(count[k]);
+	BOOST_TEST(euler == 1);
+
+	//Every facet is shared by two cells except those lying on the boundary:
+	size_t bound = 0;
+	for (const auto &link: mesh.template link<N - 1>()) {
+		BOOST_TEST((link.size() == 1 || link.size() == 2));
+		bound += link.size() == 1;
+	}
+	BOOST_TEST(bound == 2 * N * power / n * faces);
+
+	for (const auto &v: mesh.vert())
+	for (unsigned a = 0; a < N; ++ a) {
+		BOOST_TEST((v[a] >= -1 && v[a] <= +1));
+	}
+	BOOST_TEST(GEOM::TEST::checkDuplicate(mesh));
+}
+
+BOOST_AUTO_TEST_CASE(test_lattice) {
+
+	using namespace GEOM::MESH;
+
+	BOOST_TEST_MESSAGE("Testing lattice generators");
+
+	GEOM::TASK::t_pool pool(4, 16);
+	check_grid<1>(getRectGrid<1>(7), getRectGrid<1>(7, pool), 7, 1, 1);
+	check_grid<2>(getRectGrid<2>(5), getRectGrid<2>(5, pool), 5, 1, 1);
+	check_grid<3>(getRectGrid<3>(4), getRectGrid<3>(4, pool), 4, 1, 1);
+	check_grid<4>(getRectGrid<4>(3), getRectGrid<4>(3, pool), 3, 1, 1);
+	check_grid<2>(getTetrGrid<2>(5), getTetrGrid<2>(5, pool), 5, 2, 1);
+	check_grid<3>(getTetrGrid<3>(4), getTetrGrid<3>(4, pool), 4, 6, 2);
+	check_grid<4>(getTetrGrid<4>(2), getTetrGrid<4>(2, pool), 2, 24, 6);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
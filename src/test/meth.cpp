@@ -0,0 +1,382 @@
+#include <boost/test/unit_test.hpp>
+#include <geom/meth.hpp>
+#include <geom/test.hpp>
+#include "../mesh.hpp"
+
+BOOST_AUTO_TEST_SUITE(suite_of_method_tests)
+
+template <unsigned N> static bool equal_grid(const GEOM::MESH::t_grid<N> &grid1, const GEOM::MESH::t_grid<N> &grid2) {
+	if constexpr (N > 1) {
+		if (!equal_grid(grid1.template grid<N - 1>(), grid2.template grid<N - 1>())) return false;
+	}
+	return (grid1.template cell<N>() == grid2.template cell<N>()) &&
+	       (grid1.template link<N - 1>() == grid2.template link<N - 1>());
+}
+
+template <typename T, unsigned N, unsigned M>
+static bool equal_mesh(const GEOM::MESH::t_mesh<T, N, M> &mesh1, const GEOM::MESH::t_mesh<T, N, M> &mesh2) {
+	return (mesh1.vert() == mesh2.vert()) && equal_grid(mesh1.grid(), mesh2.grid());
+}
+
+BOOST_AUTO_TEST_CASE(test_section) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing mesh sections");
+
+	const auto mesh = getRectMesh3D(POLYTOP);
+	const auto sect = getSection(mesh, t_plane_3d());
+
+	BOOST_TEST(sect.vert().size() == 4);
+	BOOST_TEST(sect.edge().size() == 4);
+	BOOST_TEST(sect.face().size() == 1);
+	BOOST_TEST(GEOM::TEST::checkDuplicate(sect));
+
+	const auto clip = getClipped(mesh, t_vector_3d{0., 0., 0.}, t_vector_3d{0., 0., 1.});
+
+	BOOST_TEST(clip.vert().size() == 8);
+	BOOST_TEST(clip.edge().size() == 12);
+	BOOST_TEST(clip.face().size() == 6);
+	BOOST_TEST(clip.body().size() == 1);
+	BOOST_TEST(GEOM::TEST::checkDuplicate(clip));
+
+	//Every face of clipped cube belongs to the single body:
+	BOOST_TEST(clip.link<2>().size() == 6);
+	for (int i = 0; i < 6; ++ i) {
+		BOOST_TEST(clip.link<2>()[i].size() == 1);
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_project) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing mesh projections");
+
+	//Projections share the grid with the source mesh:
+	const auto surf = getRectSurf4D(POLYTOP);
+	const auto proj1 = getProject(surf, t_space<4, 3>());
+	BOOST_TEST(&proj1.grid() == &surf.grid());
+
+	const auto mesh = getRectMesh4D(POLYTOP);
+	const auto proj2 = getProject(mesh, t_space<4, 3>());
+	BOOST_TEST(&proj2.grid() == &mesh.grid().grid<3>());
+	BOOST_TEST(proj2.vert().size() == mesh.vert().size());
+	BOOST_TEST(proj2.body().size() == 8);
+	for (int i = 0; i < mesh.vert().size(); ++ i) {
+		BOOST_TEST(proj2.vert()[i][2] == mesh.vert()[i][2]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_moving_section) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing moving sections");
+
+	GEOM::TASK::t_pool pool(4, 1);
+
+	//Plane passes through vertices and stays between them:
+	const std::vector<double> offs{-2.0, -1.0, -0.5, -0.2, -0.2, 0.0, 0.3, 0.6, 1.0, 0.0, 2.0, -0.4};
+
+	const t_mesh_4d cube = getRectMesh4D(POLYTOP);
+	t_section<double, 4, 4> sect1(cube);
+	for (double w: offs) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.0, 0.0, 0.0, w});
+		BOOST_TEST(equal_mesh(sect1.update(basis), getSection(cube, basis)));
+	}
+
+	const t_mesh_4d mesh = getRectMesh4D(POLYTOP).rot(0, 3, 0.3).rot(1, 2, 0.2).rot(2, 3, 0.1);
+	t_section<double, 4, 4> sect2(mesh);
+	for (double w: offs) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.1, 0.0, -0.1, w}).rot(1, 3, 0.4);
+		BOOST_TEST(equal_mesh(sect2.update(basis, pool), getSection(mesh, basis)));
+		BOOST_TEST(equal_mesh(sect2.mesh(), getSection(mesh, basis)));
+	}
+
+	const auto surf = getRectSurf4D(POLYTOP);
+	t_section<double, 4, 3> sect3(surf);
+	for (double w: offs) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.0, 0.0, 0.0, w}).rot(0, 3, 0.2);
+		BOOST_TEST(equal_mesh(sect3.update(basis), getSection(surf, basis)));
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_sections) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing stacks of parallel sections");
+
+	GEOM::TASK::t_pool pool(4, 1);
+
+	const std::vector<double> offs{-2.0, -1.0, -0.7, -0.5, -0.1, 0.0, 0.0, 0.25, 0.5, 1.0, 3.0};
+
+	const t_mesh_4d mesh = getRectMesh4D(POLYTOP).rot(0, 3, 0.3).rot(1, 2, 0.2).rot(2, 3, 0.1);
+	const auto basis = t_space<4, 3>(t_vector_4d{0.1, 0.0, -0.1, 0.2}).rot(1, 3, 0.4);
+	const auto normal = basis.ext<4>()[3];
+	const auto sect1 = getSections(mesh, basis, offs, pool);
+	BOOST_TEST(sect1.size() == offs.size());
+	for (size_t k = 0; k < offs.size(); ++ k) {
+		BOOST_TEST(equal_mesh(sect1[k], getSection(mesh, basis.mov(offs[k] * normal))));
+	}
+
+	const t_mesh_4d cube = getRectMesh4D(POLYTOP);
+	const auto sect2 = getSections(cube, t_space<4, 3>(), offs);
+	for (size_t k = 0; k < offs.size(); ++ k) {
+		BOOST_TEST(equal_mesh(sect2[k], getSection(cube, t_space<4, 3>(t_vector_4d{0.0, 0.0, 0.0, offs[k]}))));
+	}
+
+	const auto surf = getRectSurf4D(POLYTOP);
+	const auto sect3 = getSections(surf, t_space<4, 3>().rot(0, 3, 0.2), offs, pool);
+	for (size_t k = 0; k < offs.size(); ++ k) {
+		const auto basis = t_space<4, 3>().rot(0, 3, 0.2);
+		BOOST_TEST(equal_mesh(sect3[k], getSection(surf, basis.mov(offs[k] * basis.ext<4>()[3]))));
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_culled_section) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing sections culled by bounding boxes");
+
+	const t_mesh_4d mesh = getRectMesh4D(POLYTOP).rot(0, 3, 0.3).rot(1, 2, 0.2).rot(2, 3, 0.1);
+	BOOST_TEST(mesh.bvh().size() == mesh.cell<4>().size());
+	BOOST_TEST(&mesh.bvh() == &mesh.bvh());
+
+	for (double w: {-2.0, -0.5, 0.0, 0.2, 0.7}) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.1, 0.0, -0.1, w}).rot(1, 3, 0.4);
+		BOOST_TEST(equal_mesh(getCulledSection(mesh, basis), getSection(mesh, basis)));
+	}
+
+	//Plane passes through vertices and faces of the cube:
+	const t_mesh_4d cube = getRectMesh4D(POLYTOP);
+	for (double w: {-1.0, -0.5, 0.0, 0.5, 1.0}) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.0, 0.0, 0.0, w});
+		BOOST_TEST(equal_mesh(getCulledSection(cube, basis), getSection(cube, basis)));
+	}
+
+	const auto surf = getRectSurf4D(POLYTOP);
+	for (double w: {-0.3, 0.0, 0.4}) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.0, 0.0, 0.0, w}).rot(0, 3, 0.2);
+		BOOST_TEST(equal_mesh(getCulledSection(surf, basis), getSection(surf, basis)));
+	}
+
+	//Lattices with many cells of every dimension:
+	const auto grid = getTetrGrid<3>(6);
+	GEOM::TASK::t_pool pool(4, 16);
+	for (double w: {-0.35, 0.0, 1.0 / 3}) {
+		const auto basis = t_space<3, 2>(t_vector_3d{0.0, 0.0, w}).rot(0, 2, 0.3).rot(1, 2, 0.2);
+		const auto sect = getSection(grid, basis);
+		BOOST_TEST(equal_mesh(getCulledSection(grid, basis), sect));
+		BOOST_TEST(GEOM::TEST::checkDuplicate(sect));
+		BOOST_TEST(equal_mesh(getCulledSection(grid, basis, pool), sect));
+	}
+	const auto rect = getRectGrid<4>(3);
+	const auto basis = t_space<4, 3>(t_vector_4d{0.1, 0.0, -0.1, 0.2}).rot(1, 3, 0.4);
+	BOOST_TEST(equal_mesh(getCulledSection(rect, basis), getSection(rect, basis)));
+
+	//Only tetrahedra touching the plane are found:
+	const t_mesh_3d tetr = getRectMesh3D(COMPLEX);
+	BOOST_TEST(tetr.bvh().find(t_vector_3d{0., 0., 3.}, t_vector_3d{0., 0., 1.}, 0.5).empty());
+	BOOST_TEST(tetr.bvh().find(t_vector_3d{0., 0., 0.}, t_vector_3d{0., 0., 1.}, 0.0).size() == 6);
+	for (double z: {-1.0, -0.4, 0.0, 0.5}) {
+		const auto basis = t_space<3, 2>(t_vector_3d{0., 0., z}).rot(0, 2, 0.3);
+		BOOST_TEST(equal_mesh(getCulledSection(tetr, basis), getSection(tetr, basis)));
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_workspace) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing sections with reused workspace");
+
+	GEOM::TASK::t_pool pool(4, 1);
+	GEOM::TASK::t_pool single(1);
+	t_sect_work<double> work;
+
+	//Larger meshes and pools leave more data in the workspace than the next calls need:
+	const t_mesh_4d mesh = getRectMesh4D(POLYTOP).rot(0, 3, 0.3).rot(1, 2, 0.2).rot(2, 3, 0.1);
+	const auto surf = getRectSurf4D(POLYTOP);
+	const t_mesh_3d tetr = getRectMesh3D(COMPLEX);
+	for (double w: {0.2, -0.4, 0.0}) {
+		const auto basis = t_space<4, 3>(t_vector_4d{0.1, 0.0, -0.1, w}).rot(1, 3, 0.4);
+		const t_vector_4d normal{0.3, 0.2, 0.1, 1.0};
+		BOOST_TEST(equal_mesh(getSection(mesh, basis, pool, work), getSection(mesh, basis)));
+		BOOST_TEST(equal_mesh(getClipped(mesh, basis.center(), normal, pool, work), getClipped(mesh, basis.center(), normal)));
+		BOOST_TEST(equal_mesh(getSection(surf, basis, single, work), getSection(surf, basis)));
+		BOOST_TEST(equal_mesh(getClipped(surf, basis.center(), normal, single, work), getClipped(surf, basis.center(), normal)));
+		const auto plane = t_space<3, 2>(t_vector_3d{0., 0., w}).rot(0, 2, 0.3);
+		BOOST_TEST(equal_mesh(getSection(tetr, plane, pool, work), getSection(tetr, plane)));
+	}
+
+}
+
+#ifdef GEOM_STATS
+BOOST_AUTO_TEST_CASE(test_stats) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing statistics of section methods");
+
+	const auto mesh = getRectGrid<3>(8);
+	const auto plane = t_space<3, 2>(t_vector_3d{0.01, 0.02, 0.03}).rot(0, 2, 0.3).rot(1, 2, 0.2);
+	const auto normal = plane.ext<3>()[2];
+	GEOM::TASK::t_pool pool(4, 16);
+	t_sect_work<double> work;
+
+	auto check_time = [](const t_stats &stats) {
+		double sum = 0;
+		for (double t: stats.TIME) { BOOST_TEST(t >= 0); sum += t; }
+		BOOST_TEST(sum <= stats.TOTAL);
+	};
+
+	for (int k = 0; k < 2; ++ k) {
+		//Plane passes through no vertex, so every new vertex is a crossed edge:
+		const auto sect = getSection(mesh, plane, pool, work);
+		const auto &stats = getStats();
+		BOOST_TEST(stats.VERT == mesh.vert().size());
+		BOOST_TEST(stats.EDGE == sect.vert().size());
+		BOOST_TEST(stats.CELL[0] == sect.vert().size());
+		BOOST_TEST(stats.CELL[1] == sect.edge().size());
+		BOOST_TEST(stats.CELL[2] == sect.face().size());
+		BOOST_TEST(stats.CELL[3] == 0);
+		check_time(stats);
+		//Workspace has grown only on the first call:
+		if (k) BOOST_TEST(stats.ALLOC == 0); else BOOST_TEST(stats.ALLOC > 0);
+	}
+
+	const auto clip = getClipped(mesh, plane.center(), normal, pool, work);
+	BOOST_TEST(getStats().VERT == mesh.vert().size());
+	BOOST_TEST(getStats().CELL[1] == clip.edge().size());
+	BOOST_TEST(getStats().CELL[3] == clip.body().size());
+	check_time(getStats());
+
+	const auto proj = getProject(mesh, plane);
+	BOOST_TEST(getStats().VERT == proj.vert().size());
+	BOOST_TEST(getStats().CELL[2] == proj.face().size());
+}
+#endif
+
+//Meshes of different precision have equal grids and close vertices:
+template <typename T1, typename T2, unsigned N, unsigned M>
+static bool close_mesh(const GEOM::MESH::t_mesh<T1, N, M> &mesh1, const GEOM::MESH::t_mesh<T2, N, M> &mesh2, double eps) {
+	if (!equal_grid(mesh1.grid(), mesh2.grid()) || (mesh1.vert().size() != mesh2.vert().size())) return false;
+	for (size_t i = 0; i < mesh1.vert().size(); ++ i)
+	for (unsigned k = 0; k < N; ++ k) {
+		if (std::abs(double(mesh1.vert()[i][k]) - double(mesh2.vert()[i][k])) > eps) return false;
+	}
+	return true;
+}
+
+BOOST_AUTO_TEST_CASE(test_float) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing single and mixed precision sections");
+
+	const t_mesh_3d mesh = getRectGrid<3, double>(6);
+	const t_mesh_3f meshf = getRectGrid<3, float>(6);
+	BOOST_TEST(sizeof(t_mesh_3f::t_vert) == 3 * sizeof(float));
+
+	const auto plane = t_space<3, 2>(t_vector_3d{0.01, 0.02, 0.03}).rot(0, 2, 0.3).rot(1, 2, 0.2);
+	const auto planef = t_space_f<3, 2>(t_vector_3f{0.01f, 0.02f, 0.03f}).rot(0, 2, 0.3f).rot(1, 2, 0.2f);
+	const auto normal = plane.ext<3>()[2];
+	const auto normalf = planef.ext<3>()[2];
+
+	GEOM::TASK::t_pool pool(4, 16);
+	t_sect_work<double> work;
+
+	const auto sect = getSection(mesh, plane);
+	const auto sectf = getSection(meshf, planef);
+	BOOST_TEST(close_mesh(sectf, sect, 1.e-5));
+	BOOST_TEST(GEOM::TEST::checkDuplicate(sectf));
+
+	//Float vertices are classified and cut in double:
+	const t_mesh<float, 2> sectm = getSection(meshf, plane, pool, work);
+	BOOST_TEST(close_mesh(sectm, sect, 1.e-6));
+
+	const auto clip = getClipped(mesh, plane.center(), normal);
+	BOOST_TEST(close_mesh(getClipped(meshf, planef.center(), normalf), clip, 1.e-5));
+	BOOST_TEST(close_mesh(getClipped(meshf, plane.center(), normal, pool, work), clip, 1.e-6));
+
+	//Vertices within the tolerance are taken to lie on the plane (layer of the grid at zero):
+	const t_vector_3d layer{0.0, 0.0, 0.0}, shift{0.0, 0.0, 1.e-4}, direct{0.0, 0.0, 1.0};
+	work.EPS = 1.e-3;
+	BOOST_TEST(equal_mesh(getClipped(mesh, shift, direct, pool, work), getClipped(mesh, layer, direct)));
+	work.EPS = getEpsilon<double>();
+	BOOST_TEST(!equal_mesh(getClipped(mesh, shift, direct, pool, work), getClipped(mesh, layer, direct)));
+
+	//Other section methods take the same tolerance (plane just above the cube touches its top face):
+	const t_mesh_3d cube = getRectMesh3D(POLYTOP);
+	const auto basis = t_space<3, 2>(t_vector_3d{0.0, 0.0, 1.0 + 1.e-4});
+	work.EPS = 1.e-3;
+	const auto near = getSection(cube, basis, pool, work);
+	BOOST_TEST(near.vert().size() == 4);
+	BOOST_TEST(getSection(cube, basis).vert().empty());
+	t_section<double, 3, 3> moving(cube, 1.e-3);
+	BOOST_TEST(equal_mesh(moving.update(basis, pool), near));
+	BOOST_TEST(equal_mesh(getSections(cube, t_space<3, 2>(), {0.0, 1.0 + 1.e-4}, pool, 1.e-3)[1], near));
+	BOOST_TEST(equal_mesh(getCulledSection(cube, basis, pool, 1.e-3), near));
+	work.EPS = getEpsilon<double>();
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::MESH;
+	using namespace GEOM::METH;
+
+	BOOST_TEST_MESSAGE("Testing parallel sections");
+
+	//Split every loop into parts of single item:
+	GEOM::TASK::t_pool pool(4, 1);
+
+	const t_mesh_4d mesh = getRectMesh4D(POLYTOP).rot(0, 3, 0.3).rot(1, 2, 0.2).rot(2, 3, 0.1);
+	const t_vector_4d center{0.1, 0.0, -0.1, 0.2};
+	const t_vector_4d normal{0.3, 0.2, 0.1, 1.0};
+
+	BOOST_TEST(equal_mesh(
+		getSection(mesh, t_space<4, 3>(center).rot(1, 3, 0.4), pool),
+		getSection(mesh, t_space<4, 3>(center).rot(1, 3, 0.4))
+	));
+	BOOST_TEST(equal_mesh(
+		getClipped(mesh, center, normal, pool),
+		getClipped(mesh, center, normal)
+	));
+
+	//Exception of any part is rethrown after all parts are done, the pool stays usable
+	for (unsigned fail: {0u, 3u}) {
+		BOOST_CHECK_THROW(pool.run(4, [fail](unsigned part, size_t, size_t) {
+			if (part == fail) throw std::runtime_error("fail");
+		}), std::runtime_error);
+	}
+	std::vector<int> done(4, 0);
+	pool.run(4, [&](unsigned part, size_t, size_t) { done[part] = 1; });
+	BOOST_TEST(done == std::vector<int>(4, 1), boost::test_tools::per_element());
+
+}
+
+BOOST_AUTO_TEST_SUITE_END()
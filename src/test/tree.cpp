@@ -0,0 +1,210 @@
+#include <boost/test/unit_test.hpp>
+#include <geom/tree.hpp>
+#include <random>
+
+BOOST_AUTO_TEST_SUITE(suite_of_tree_tests)
+
+template <typename T, unsigned N>
+static std::vector<GEOM::BASE::t_vector<T, N>> get_vert(size_t num, unsigned seed) {
+	std::mt19937 gen(seed);
+	std::uniform_real_distribution<T> rnd(-1, 1);
+	std::vector<GEOM::BASE::t_vector<T, N>> vert(num);
+	for (auto &v: vert) for (int i = 0; i < N; ++ i) {
+		//Coarse grid makes points lie on split planes:
+		v[i] = std::round(rnd(gen) * 8) / 8;
+	}
+	return vert;
+}
+
+template <typename T, unsigned N> static void test_find(size_t num) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::TREE;
+
+	const auto vert = get_vert<T, N>(num, num);
+	const t_tree<T, N> tree(vert.data(), vert.size());
+	BOOST_TEST(tree.size() == num);
+
+	for (int k = 0; k < 50; ++ k) {
+		const t_rect<T, N> rect{vert[k % num] - T(0.25), vert[(k * 7) % num] + T(0.25)};
+		std::vector<ptrdiff_t> list;
+		for (int i = 0; i < num; ++ i) {
+			bool test = true;
+			for (int j = 0; j < N; ++ j) {
+				test = test && (vert[i][j] >= rect.min[j]) && (vert[i][j] <= rect.max[j]);
+			}
+			if (test) list.push_back(i);
+		}
+		auto find = tree.find(rect);
+		std::sort(find.begin(), find.end());
+		BOOST_TEST(find == list);
+	}
+}
+
+template <typename T, unsigned N> static void test_near(size_t num, size_t k) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::TREE;
+
+	const auto vert = get_vert<T, N>(num, num + 1);
+	const auto test = get_vert<T, N>(40, num + 2);
+	const t_tree<T, N> tree(vert.data(), vert.size());
+	const T dist = 0.3;
+
+	std::vector<std::vector<ptrdiff_t>> near_list, ball_list;
+	for (const auto &v: test) {
+		std::vector<std::pair<T, ptrdiff_t>> item;
+		for (int i = 0; i < num; ++ i) {
+			item.emplace_back((vert[i] - v) * (vert[i] - v), i);
+		}
+		std::sort(item.begin(), item.end());
+		std::vector<ptrdiff_t> near, ball;
+		for (int i = 0; i < num; ++ i) {
+			if (i < k) near.push_back(item[i].second);
+			if (item[i].first <= dist * dist) ball.push_back(item[i].second);
+		}
+		std::sort(ball.begin(), ball.end());
+		near_list.push_back(near);
+		ball_list.push_back(ball);
+	}
+
+	GEOM::TASK::t_pool pool(4, 1);
+	const auto near_pool = tree.nearest(test, k, pool);
+	const auto ball_pool = tree.within(test, dist, pool);
+	for (int i = 0; i < test.size(); ++ i) {
+		auto ball = tree.within(test[i], dist);
+		std::sort(ball.begin(), ball.end());
+		BOOST_TEST(tree.nearest(test[i], k) == near_list[i]);
+		BOOST_TEST(near_pool[i] == near_list[i]);
+		BOOST_TEST(ball == ball_list[i]);
+		BOOST_TEST(ball_pool[i].size() == ball.size());
+	}
+}
+
+template <typename T, unsigned N> static void test_build(size_t num, GEOM::TREE::t_split split) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::TREE;
+
+	const auto vert = get_vert<T, N>(num, num + 3);
+	GEOM::TASK::t_pool pool(4);
+	const t_tree<T, N> tree1(vert.data(), vert.size(), split);
+	const t_tree<T, N> tree2(vert.data(), vert.size(), pool, split);
+
+	//Parallel build must give the same tree:
+	for (int k = 0; k < 20; ++ k) {
+		const t_rect<T, N> rect{vert[k] - T(0.1), vert[k] + T(0.1)};
+		BOOST_TEST(tree1.find(rect) == tree2.find(rect));
+		BOOST_TEST(tree1.nearest(vert[k], 3) == tree2.nearest(vert[k], 3));
+	}
+	//Any split gives the same answers as the exact one:
+	const t_tree<T, N> exact(vert.data(), vert.size(), SPLIT_EXACT);
+	for (int k = 0; k < 20; ++ k) {
+		const t_rect<T, N> rect{vert[k] - T(0.1), vert[k] + T(0.1)};
+		auto find1 = tree1.find(rect), find2 = exact.find(rect);
+		std::sort(find1.begin(), find1.end());
+		std::sort(find2.begin(), find2.end());
+		BOOST_TEST(find1 == find2);
+		BOOST_TEST(tree1.nearest(vert[k], 5) == exact.nearest(vert[k], 5));
+	}
+	auto list = tree2.find(t_rect<T, N>{vert[0] - T(2), vert[0] + T(2)});
+	std::sort(list.begin(), list.end());
+	BOOST_TEST(list.size() == num);
+	BOOST_TEST(bool(std::adjacent_find(list.begin(), list.end()) == list.end()));
+}
+
+template <typename T, unsigned N> static void test_bvh(size_t num) {
+
+	using namespace GEOM::BASE;
+	using namespace GEOM::TREE;
+
+	const auto vert = get_vert<T, N>(num, num + 3);
+	const auto size = get_vert<T, N>(num, num + 4);
+	std::vector<t_rect<T, N>> rect(num);
+	for (size_t i = 0; i < num; ++ i) {
+		rect[i] = t_rect<T, N>{vert[i], vert[i]};
+		for (int j = 0; j < N; ++ j) rect[i].max[j] += std::abs(size[i][j]) / 4;
+	}
+	const t_bvh<T, N> bvh(rect);
+	BOOST_TEST(bvh.size() == num);
+
+	for (int k = 0; k < 50; ++ k) {
+		//Planes go through box corners as well:
+		t_vector<T, N> normal = vert[(k * 3) % num] - vert[(k * 5 + 1) % num];
+		if (normal * normal == 0) continue;
+		const t_vector<T, N> &center = vert[k % num];
+		const T dist = (k % 2)? T(0.1): T(0);
+		std::vector<ptrdiff_t> list;
+		for (int i = 0; i < num; ++ i) {
+			T lower = 0, upper = 0;
+			for (int j = 0; j < N; ++ j) {
+				const T a = (rect[i].min[j] - center[j]) * normal[j];
+				const T b = (rect[i].max[j] - center[j]) * normal[j];
+				lower += std::min(a, b);
+				upper += std::max(a, b);
+			}
+			if ((lower <= dist) && (upper >= - dist)) list.push_back(i);
+		}
+		auto find = bvh.find(center, normal, dist);
+		std::sort(find.begin(), find.end());
+		//Boxes are tested with a tolerance, so the result may only be wider:
+		BOOST_TEST(std::includes(find.begin(), find.end(), list.begin(), list.end()));
+		BOOST_TEST(find.size() <= list.size() + num / 100);
+
+		const t_rect<T, N> box{vert[k % num] - T(0.25), vert[(k * 7) % num] + T(0.25)};
+		list.clear();
+		for (int i = 0; i < num; ++ i) {
+			bool test = true;
+			for (int j = 0; j < N; ++ j) {
+				test = test && (rect[i].max[j] >= box.min[j]) && (rect[i].min[j] <= box.max[j]);
+			}
+			if (test) list.push_back(i);
+		}
+		find = bvh.find(box);
+		std::sort(find.begin(), find.end());
+		BOOST_TEST(find == list);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_tree) {
+
+	BOOST_TEST_MESSAGE("Testing KD-tree queries (range, nearest and radius)");
+
+	test_find<double, 2>(1);
+	test_find<double, 2>(1000);
+	test_find<double, 3>(777);
+	test_find<float, 4>(2000);
+
+	test_near<double, 2>(5, 8);
+	test_near<double, 2>(1000, 1);
+	test_near<double, 3>(777, 5);
+	test_near<float, 4>(2000, 12);
+
+	test_build<double, 3>(100000, GEOM::TREE::SPLIT_EXACT);
+	test_build<double, 2>(50000, GEOM::TREE::SPLIT_SAMPLE);
+
+	const GEOM::TREE::t_tree<double, 3> tree(nullptr, 0);
+	BOOST_TEST(tree.find(GEOM::BASE::t_rect<double, 3>()).empty());
+	BOOST_TEST(tree.nearest(GEOM::BASE::t_vector<double, 3>(), 1).empty());
+
+	//Tree does not refer to the source points after construction
+	auto vert = std::make_unique<std::vector<GEOM::BASE::t_vector<double, 2>>>(100);
+	for (int i = 0; i < 100; ++ i) (*vert)[i] = GEOM::BASE::t_vector<double, 2>(i, - i);
+	const GEOM::TREE::t_tree<double, 2> copy(vert->data(), vert->size());
+	vert.reset();
+	BOOST_TEST(copy.nearest(GEOM::BASE::t_vector<double, 2>(41.9, -42.1), 1) == std::vector<ptrdiff_t>{42});
+}
+
+BOOST_AUTO_TEST_CASE(test_boxes) {
+
+	BOOST_TEST_MESSAGE("Testing hierarchy of bounding boxes (slab and range)");
+
+	test_bvh<double, 2>(1);
+	test_bvh<double, 3>(1000);
+	test_bvh<float, 4>(3000);
+
+	const GEOM::TREE::t_bvh<double, 3> bvh({});
+	BOOST_TEST(bvh.find(GEOM::BASE::t_rect<double, 3>()).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()